@@ -0,0 +1,178 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+using namespace std;
+
+#include "geom.h"
+#include "source.h"
+#include "utils.h"
+
+#define ARCHIVE_MAGIC "LPPACK1"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_BYTE_ORDER 0x01020304
+
+#define PACK_FLOAT32 0
+#define PACK_INT16 1
+#define PACK_UINT8 2
+
+#define PACK_RAW 0
+#define PACK_ZLIB 1
+
+#define CONVERT_NORMAL 0
+#define CONVERT_ALBERS 1
+
+
+/// Header at the very start of a packed archive, followed directly by one ArchiveTile for each tile.  Everything in the archive is stored in the byte order of the machine that packed it.
+struct ArchiveHeader {
+	/// Always ARCHIVE_MAGIC
+	char magic[8];
+	/// Always ARCHIVE_VERSION
+	uint32_t version;
+	/// ARCHIVE_BYTE_ORDER as written by the packing machine, used to refuse archives from other byte orders
+	uint32_t byteOrder;
+	/// Number of tiles in the index
+	uint32_t tiles;
+	uint32_t reserved;
+};
+
+
+/// Index entry describing a single tile in a packed archive.
+struct ArchiveTile {
+	/// Enumeration describing what type of data this tile provides, such as TYPE_ELEV
+	int32_t type;
+	/// Enumeration of conversion to apply to incoming points, either CONVERT_NORMAL or CONVERT_ALBERS
+	int32_t convert;
+	/// Enumeration of value format, either PACK_FLOAT32, PACK_INT16 or PACK_UINT8
+	int32_t format;
+	/// Enumeration of payload compression, either PACK_RAW or PACK_ZLIB
+	int32_t compression;
+	int32_t ncols, nrows;
+	/// Number of rows in each compressed block
+	int32_t blockRows;
+	/// Number of compressed blocks, or 0 for raw payloads
+	int32_t blocks;
+	double left, bottom, right, top, cellsize;
+	/// Byte offset of the payload from the start of the archive.  Compressed payloads start with blocks + 1 offsets to each block, relative to the payload.
+	uint64_t offset;
+	/// Length of the payload, in bytes
+	uint64_t length;
+};
+
+
+/// Interface to a single tile inside a packed archive.  Values are read straight out of the archive memory map, and compressed blocks are inflated the first time they are touched.
+class SourcePacked : public Source {
+protected:
+	/// Enumeration of value format, either PACK_FLOAT32, PACK_INT16 or PACK_UINT8
+	int format;
+	/// Size of each value, in bytes
+	int width;
+	/// Enumeration of payload compression, either PACK_RAW or PACK_ZLIB
+	int compression;
+	/// Number of rows in each compressed block
+	int blockRows;
+	/// Number of compressed blocks
+	int blocks;
+	/// Start of our payload inside the archive memory map, and its length in bytes
+	const char* payload;
+	uint64_t length;
+	/// Inflated copy of each compressed block, or NULL until first touched
+	char** inflated;
+
+	/// Find the inflated copy of the given block, inflating it if needed.  Safe to call from multiple threads at once.
+	/// @param index Block to find
+	/// @return Inflated block data, or NULL if the block is corrupt or lies outside the payload
+	const char* block(int index);
+
+	/// Retrieve a specific value from the archive.
+	/// @param offset Offset into the tile to read
+	/// @return Value at offset location
+	double value(long offset);
+
+	/// Read many cells straight out of the archive.
+	bool readCells(const long* offsets, int count, double* values);
+
+public:
+	/// Create a new tile reading from an archive that is already mapped into memory.
+	/// @param convert The conversion to apply to all incoming points
+	/// @param tile Index entry describing this tile
+	/// @param archive Start of the archive memory map, which must outlive this tile
+	SourcePacked(Convert* convert, ArchiveTile* tile, const char* archive);
+
+	~SourcePacked();
+
+	/// Resolve a given Point by filling it with any new data this source can provide.  Will ignore given point if this source can't provide data.
+	/// @param p The point to try filling with data
+	void resolve(Point* p);
+
+	/// Resolve a given Point that has already been converted into our coordinate system.
+	/// @param p The point to try filling with data
+	/// @param x Point x coordinate after conversion
+	/// @param y Point y coordinate after conversion
+	void resolveAt(Point* p, double x, double y);
+};
+
+
+/// Collection of every tile in a packed archive.  The whole archive is loaded with a single open and memory map, so no tile needs its own header parsing or file descriptor.
+class SourceArchive : public SourceGroup {
+private:
+	/// Conversions shared by every tile, indexed by CONVERT_NORMAL or CONVERT_ALBERS
+	Convert* converts[2];
+
+public:
+	/// Load every tile from the given packed archive.  Prints a message to stderr and leaves the group empty if the archive can't be used.  Tiles whose index entry could lead outside their payload are skipped with a message.
+	/// @param filename Filename of archive created by writeArchive()
+	SourceArchive(string filename);
+
+	~SourceArchive();
+};
+
+
+/// Describe a single tile to be written into a packed archive.
+class PackInput {
+public:
+	/// Enumeration describing what type of data this tile provides.  TYPE_LAND tiles are read from ".bil" files, all others from ".flt" files.
+	int type;
+	/// Enumeration of conversion to apply to incoming points, either CONVERT_NORMAL or CONVERT_ALBERS
+	int convert;
+	/// Filename pointing to ".hdr" file for this tile
+	string filename;
+
+	/// Create a new tile description.
+	/// @param _type Enumeration describing what type of data this tile provides
+	/// @param _convert Enumeration of conversion to apply to incoming points
+	/// @param _filename Filename pointing to ".hdr" file for this tile
+	PackInput(int _type, int _convert, string _filename);
+};
+
+
+/// Write the given tiles into a single packed archive.  Elevation is kept as 32-bit floats, vegetation tiles holding only whole numbers shrink to 16-bit integers, and land use is kept as 8-bit values.
+/// @param filename Filename of archive to create
+/// @param inputs List of tiles to pack
+/// @param compression Either PACK_RAW to store values directly, or PACK_ZLIB to compress them in blocks of rows
+/// @param blockRows Number of rows in each compressed block
+/// @return True if every tile was read and the archive was written
+bool writeArchive(string filename, vector<PackInput>& inputs, int compression, int blockRows);
+
@@ -0,0 +1,72 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+/// Corner and spacing of the synthetic terrain, somewhere in the foothills of Colorado
+#define TERRAIN_LEFT -105.40
+#define TERRAIN_BOTTOM 39.60
+#define TERRAIN_CELLSIZE 0.0002
+/// Cells along each side of the whole synthetic terrain
+#define TERRAIN_CELLS 2048
+/// Tiles along each side when the terrain is split up for SourceGroup benchmarks
+#define TERRAIN_TILES 16
+
+
+/// Height of the synthetic terrain at the given location, in meters.  Made from a few long ridges and valleys plus hashed value noise, so the same location always gives the same height without any random state.
+/// @param lat Latitude to sample
+/// @param lon Longitude to sample
+/// @return Ground elevation, in meters
+double terrainHeight(double lat, double lon);
+
+/// Land use of the synthetic terrain at the given location.
+/// @param lat Latitude to sample
+/// @param lon Longitude to sample
+/// @return Raw land cover class as stored in land use tiles: 41 for forest, 22 for residential, 23 for commercial or 71 for open grassland
+int terrainLand(double lat, double lon);
+
+/// Write a synthetic elevation tile as ".hdr" and little-endian ".flt" files, readable by SourceGridFloat.
+/// @param filename Filename of the ".hdr" file to create, the ".flt" file is written beside it
+/// @param ncols Number of columns
+/// @param nrows Number of rows
+/// @param left Longitude of the left edge
+/// @param bottom Latitude of the bottom edge
+/// @param cellsize Width and height of each cell, in degrees
+/// @return True if both files were written
+bool writeTerrainElev(string filename, int ncols, int nrows, double left, double bottom, double cellsize);
+
+/// Write a synthetic land use tile as ".hdr", ".blw" and ".bil" files, readable by SourceInteger.
+/// @param filename Filename of the ".hdr" file to create, the other files are written beside it
+/// @param ncols Number of columns
+/// @param nrows Number of rows
+/// @param left Longitude of the left edge
+/// @param bottom Latitude of the bottom edge
+/// @param cellsize Width and height of each cell, in degrees
+/// @return True if every file was written
+bool writeTerrainLand(string filename, int ncols, int nrows, double left, double bottom, double cellsize);
+
+/// Write every tile used by the benchmarks into the given directory, skipping tiles that already exist: one large elevation tile and one land use tile covering the whole terrain, plus the same elevation split into TERRAIN_TILES by TERRAIN_TILES smaller tiles.
+/// @param directory Existing directory to write into
+/// @return True if every tile exists afterwards
+bool writeTerrain(string directory);
+
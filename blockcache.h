@@ -0,0 +1,161 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+#include <pthread.h>
+
+using namespace std;
+
+class Source;
+
+/// Width and height of each cached block, in cells
+#define BLOCK_CELLS 256
+#define BLOCK_SHARDS 16
+#define BLOCK_QUEUE 1024
+
+
+/// Memory-bounded cache of square blocks of cells, shared by every Source attached to it.  Blocks are read on demand with pread() and evicted with the CLOCK algorithm once the memory budget is used up.  An optional background thread reads ahead blocks that callers expect to touch soon.
+class BlockCache {
+private:
+	/// Identify a single block of a single source
+	struct Key {
+		Source* source;
+		long block;
+		bool operator==(const Key& other) const {
+			return source == other.source && block == other.block;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const {
+			return ((size_t)key.source >> 4) * 2654435761UL ^ (size_t)key.block * 40503UL;
+		}
+	};
+
+	/// Single cached block
+	struct Slot {
+		Key key;
+		char* data;
+		long size;
+		/// Set on every hit, cleared as the CLOCK hand passes
+		bool referenced;
+		/// True while a thread is still reading this block from disk
+		bool loading;
+		/// False for slots on the free list
+		bool used;
+	};
+
+	/// Independent part of the cache, each with its own lock so threads rarely wait on each other
+	struct Shard {
+		pthread_mutex_t lock;
+		/// Signalled whenever a block finishes loading
+		pthread_cond_t loaded;
+		vector<Slot> slots;
+		vector<int> free;
+		unordered_map<Key, int, KeyHash> lookup;
+		/// Position of the CLOCK hand in slots
+		unsigned int hand;
+		/// Bytes held by this shard
+		long bytes;
+	};
+
+	Shard shards[BLOCK_SHARDS];
+	/// Memory budget for each shard, in bytes
+	long budget;
+
+	long hitCount, missCount, evictCount, readAheadCount;
+
+	/// Background read-ahead thread, if started
+	bool readAhead;
+	pthread_t reader;
+	pthread_mutex_t queueLock;
+	pthread_cond_t queued, idle;
+	deque<Key> queue;
+	/// Source the read-ahead thread is currently reading from, or NULL
+	Source* reading;
+	bool stopping;
+
+	static void* main(void* data);
+
+	Shard* shard(Key& key);
+
+	/// Make sure the given block is in the cache, loading it if needed, and return its slot with the shard locked.
+	/// @return Slot index, or -1 if the block couldn't be read
+	int fetch(Shard* s, Key& key, bool* hit);
+
+	/// Evict blocks until there is room for the given number of new bytes.  Called with the shard locked.
+	void evict(Shard* s, long size);
+
+	/// Read the given block from its source into a new buffer.
+	/// @return Newly allocated block data, or NULL if it couldn't be read
+	char* load(Key& key, long* size);
+
+public:
+	/// Create a new block cache.
+	/// @param _budget Maximum memory to use for cached blocks, in bytes
+	/// @param _readAhead True to start a background thread serving prefetch() requests
+	BlockCache(long _budget, bool _readAhead = true);
+
+	~BlockCache();
+
+	/// Copy a single cell out of the cache, reading its block first if needed.  Safe to call from multiple threads at once.
+	/// @param source Source owning the cell
+	/// @param offset Offset of the cell into the source data file, counted in cells
+	/// @param out Output buffer with room for one cell of the source
+	/// @return True if the cell was copied, or false if its block couldn't be read
+	bool read(Source* source, long offset, char* out);
+
+	/// Copy many cells out of the cache at once.  Cells are grouped by block, so each block is locked and looked up only once however many of the cells it holds.  Safe to call from multiple threads at once.
+	/// @param source Source owning the cells
+	/// @param offsets Offsets of the cells into the source data file, counted in cells
+	/// @param count Number of cells
+	/// @param out Output buffer with room for count cells of the source, in the same order as offsets
+	/// @return True if every cell was copied, or false if any of their blocks couldn't be read
+	bool readList(Source* source, const long* offsets, int count, char* out);
+	
+	/// Ask the read-ahead thread to load the block holding the given cell soon.  Returns immediately, and does nothing if the block is already cached or the queue is full.
+	/// @param source Source owning the cell
+	/// @param offset Offset of the cell into the source data file, counted in cells
+	void prefetch(Source* source, long offset);
+
+	/// Drop every block and pending prefetch belonging to the given source.  Called when a source is destroyed.
+	/// @param source Source to forget about
+	void forget(Source* source);
+
+	/// Number of reads that found their block already cached.
+	long hits();
+
+	/// Number of reads that had to wait for their block to be read from disk.
+	long misses();
+
+	/// Number of blocks thrown out to stay under the memory budget.
+	long evictions();
+
+	/// Number of blocks read by the read-ahead thread.
+	long readAheads();
+
+	/// Memory currently held by cached blocks, in bytes.
+	long size();
+};
+
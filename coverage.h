@@ -0,0 +1,384 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+using namespace std;
+
+#include "geom.h"
+#include "losscache.h"
+#include "radio.h"
+#include "raster.h"
+#include "shard.h"
+#include "source.h"
+#include "utils.h"
+
+#define MODEL_KNIFE 0
+#define MODEL_LONGLEY 1
+
+/// Receivers created and calculated at a time when computing over a DiscreteRange
+#define COVERAGE_BATCH 65536
+/// How far below the steepest ground of its ray a swept receiver must sit, in meters, before it's denied without walking its path
+#define SWEEP_SLACK 0.001
+
+/// Server index given to receivers that no transmitter reaches
+#define SERVER_NONE -1
+/// Signal to interference ratio given to receivers that hear no other transmitter on the same frequency, in dB
+#define SIR_CLEAR 1024
+
+
+/// Signature of a task run by ThreadPool over a range of indexes.
+/// @param arg Opaque argument handed to ThreadPool::run()
+/// @param start First index to process
+/// @param end One past the last index to process
+/// @param worker Index of the worker thread running this range, useful for per-thread scratch space
+typedef void (*PoolTask)(void* arg, long start, long end, int worker);
+
+
+/// Pool of worker threads that split a range of indexes between themselves.  Each worker starts with its own contiguous slice so neighboring indexes stay on the same thread, and idle workers steal half of the remaining work from the busiest slice.
+class ThreadPool {
+private:
+	/// Remaining range of work owned by a single worker
+	struct Slice {
+		pthread_mutex_t lock;
+		long next, end;
+	};
+
+	/// Identity handed to each worker thread when it starts
+	struct Worker {
+		ThreadPool* pool;
+		int index;
+	};
+
+	int threads;
+	pthread_t* handles;
+	Worker* workers;
+	Slice* slices;
+
+	pthread_mutex_t lock;
+	pthread_cond_t wake, finished;
+	/// Held for the whole of each run(), so jobs from different callers take turns
+	pthread_mutex_t running;
+	/// Incremented for every run() so sleeping workers know a new job arrived
+	long generation;
+	/// Number of workers still busy on the current job
+	int active;
+	bool stopping;
+
+	PoolTask task;
+	void* arg;
+	long chunk;
+
+	static void* main(void* data);
+	void work(int worker);
+	bool take(int worker, long* start, long* end);
+	bool steal(int worker, long* start, long* end);
+
+public:
+	/// Create a new pool of worker threads.
+	/// @param _threads Number of worker threads to start, or 0 to use one per online processor
+	ThreadPool(int _threads);
+
+	~ThreadPool();
+
+	/// Number of worker threads in this pool.
+	/// @return Worker thread count
+	int size();
+
+	/// Run the given task over every index in [0, count), blocking until all of them are finished.  Safe to call from multiple threads at once, each job waits for the one before it to finish, but tasks must never call run() on their own pool.
+	/// @param count Total number of indexes to process
+	/// @param _chunk Number of indexes handed to a task at a time
+	/// @param _task Function to call for each chunk
+	/// @param _arg Opaque argument passed along to each task call
+	void run(long count, long _chunk, PoolTask _task, void* _arg);
+};
+
+
+/// Describe the propagation model and link budget used for each path.
+class ModelParams {
+public:
+	/// Enumeration of model to run, either MODEL_KNIFE or MODEL_LONGLEY
+	int model;
+	/// Detail used to step along the line-of-sight path, in kilometers
+	double resolution;
+	/// Transmitter power, in mW
+	double txPower;
+	/// Total antenna gain of both receiver and transmitter, in dB
+	double antenna;
+	/// Frequency that radios operate at, in MHz
+	double freq;
+	/// Height of the transmitter in meters, or negative to use the towerHeight of the origin point
+	double txHeight;
+	/// Height of the receiver in meters, or negative to use the towerHeight of the destination point
+	double rxHeight;
+	/// Ground and atmosphere settings, only used by MODEL_LONGLEY
+	LongleySettings longley;
+	/// Longley-Rice model prepared for longley and freq.  Paths prepare their own copy whenever it no longer matches, so call prepare() after changing either.
+	LongleyModel prepared;
+
+	/// Create new parameters using 10 meter steps, 4 watt transmitter, no antennas, and 900MHz radio system.
+	ModelParams();
+
+	/// Create new parameters with the given values.
+	/// @param _model Enumeration of model to run, either MODEL_KNIFE or MODEL_LONGLEY
+	/// @param _resolution Detail used to step along the line-of-sight path, in kilometers
+	/// @param _txPower Transmitter power, in mW
+	/// @param _antenna Total antenna gain of both receiver and transmitter, in dB
+	/// @param _freq Frequency that radios operate at, in MHz
+	ModelParams(int _model, double _resolution, double _txPower, double _antenna, double _freq);
+
+	/// Prepare the Longley-Rice model again for the current longley settings and freq.  Not safe to call while other threads are calculating with these parameters.
+	void prepare();
+};
+
+
+/// Calculate the loss along a single path using whichever model the given parameters ask for.
+/// @param p Signal origin point, with towerHeight set
+/// @param q Signal destination point, with towerHeight set
+/// @param s SourceGroup to provide elevation and vegetation data as required
+/// @param m Model and link budget to use
+/// @return Calculated loss along given path, in dBm, or DENIED
+double modelLoss(Point* p, Point* q, SourceGroup* s, ModelParams* m);
+
+/// Calculate the loss along a single path using whichever model the given parameters ask for, using the given profile as scratch space.
+/// @param p Signal origin point, with towerHeight set
+/// @param q Signal destination point, with towerHeight set
+/// @param s SourceGroup to provide elevation and vegetation data as required
+/// @param profile Scratch profile to fill with the path, overwritten by this call
+/// @param m Model and link budget to use
+/// @return Calculated loss along given path, in dBm, or DENIED
+double modelLoss(Point* p, Point* q, SourceGroup* s, TerrainProfile* profile, ModelParams* m);
+
+
+/// Calculate the loss along a single path for every one of the given parameter sets.  The path is only sampled and resolved again when the resolution changes between sets, so listing sets with the same resolution next to each other pays for terrain only once.  A knife-edge set that is the last one at its resolution goes through pathLossCulled(), and only reads the samples its elevation bounds can't settle.
+/// @param p Signal origin point, with towerHeight set
+/// @param q Signal destination point, with towerHeight set
+/// @param s SourceGroup to provide elevation and vegetation data as required
+/// @param profile Scratch profile to fill with the path, overwritten by this call
+/// @param params Array of parameter sets to evaluate
+/// @param count Number of parameter sets
+/// @param results Output array with room for count values, filled with loss in dBm or DENIED for each set
+void modelLossTable(Point* p, Point* q, SourceGroup* s, TerrainProfile* profile, ModelParams* params, int count, double* results);
+
+/// Same as modelLossTable(), for endpoints that have already been resolved.  Lets callers pairing one receiver with many towers resolve each point only once, and share resolved towers between threads since neither point is modified.
+/// @param p Signal origin point, with towerHeight set and already resolved
+/// @param q Signal destination point, with towerHeight set and already resolved
+/// @param s SourceGroup to provide elevation and vegetation data as required
+/// @param profile Scratch profile to fill with the path, overwritten by this call
+/// @param params Array of parameter sets to evaluate
+/// @param count Number of parameter sets
+/// @param results Output array with room for count values, filled with loss in dBm or DENIED for each set
+void modelLossTableResolved(Point* p, Point* q, SourceGroup* s, TerrainProfile* profile, ModelParams* params, int count, double* results);
+
+
+/// Single transmitter site for multi-transmitter coverage.
+class Transmitter {
+public:
+	/// Location of the tower, with towerHeight set
+	Point tower;
+	/// Model, power, antenna gain and frequency of this transmitter
+	ModelParams params;
+
+	/// Create a transmitter at an unknown location with default parameters.
+	Transmitter();
+
+	/// Create a new transmitter.
+	/// @param _tower Location of the tower, with towerHeight set
+	/// @param _params Model, power, antenna gain and frequency of this transmitter
+	Transmitter(Point _tower, ModelParams _params);
+};
+
+
+/// Best server and interference at a single receiver, as found by Coverage::computeServers().
+class BestServer {
+public:
+	/// Index of the transmitter with the strongest signal, or SERVER_NONE if none reach this receiver
+	int server;
+	/// Signal from the best server, in dBm, or DENIED
+	double signal;
+	/// Ratio of the best signal to the sum of every other signal on the same frequency, in dB, or SIR_CLEAR if no other transmitter on that frequency is heard
+	double sir;
+
+	/// Create an empty result, with no server.
+	BestServer();
+};
+
+
+/// Coverage engine that spreads path loss calculations from a single tower, or from many towers at once, across a ThreadPool.  Receivers are visited in Z-order so that each thread keeps hitting the same data tiles.
+class Coverage {
+private:
+	SourceGroup* sources;
+	ThreadPool* pool;
+	/// Scratch profile for each worker thread, reused for every path it calculates
+	vector<TerrainProfile*> profiles;
+
+	/// Per-job state shared with the worker threads
+	struct Job {
+		Coverage* owner;
+		Point* tower;
+		vector<Point*>* receivers;
+		long* order;
+		double* results;
+		ModelParams* params;
+		/// Number of parameter sets, each receiver fills one row of this many results
+		int count;
+	};
+
+	/// Per-sweep state shared with the worker threads
+	struct Sweep {
+		Coverage* owner;
+		/// Signal origin point, already resolved
+		Point* tower;
+		/// Angle between neighboring rays, in radians
+		double step;
+		double rxHeight;
+		/// For each ray, the sample index and receiver index of every receiver that landed on it, sorted by sample
+		vector<vector<pair<int, long> > >* wants;
+		double* results;
+		ModelParams* params;
+	};
+
+	/// Per-job state for multi-transmitter coverage, shared with the worker threads
+	struct Servers {
+		Coverage* owner;
+		/// Every tower, already resolved
+		vector<Point>* towers;
+		vector<Transmitter>* transmitters;
+		vector<Point*>* receivers;
+		long* order;
+		BestServer* results;
+	};
+
+	static void task(void* arg, long start, long end, int worker);
+	static void serversTask(void* arg, long start, long end, int worker);
+	static void sweepTask(void* arg, long start, long end, int worker);
+
+	pthread_mutex_t progressLock;
+
+public:
+	/// Optional progress display, incremented once for every receiver finished
+	TimeRemaining* progress;
+
+	/// Number of receivers handed to a worker at a time
+	long chunk;
+
+	/// Create a new coverage engine.
+	/// @param _sources SourceGroup to provide elevation and vegetation data for every path
+	/// @param _pool Worker threads to spread calculations across
+	Coverage(SourceGroup* _sources, ThreadPool* _pool);
+
+	~Coverage();
+
+	/// Calculate the loss from the tower to every receiver in the list.  The tower is never modified, so it can be shared with other threads.
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param receivers List of destination points, each with towerHeight set
+	/// @param results Output array with room for one value per receiver, filled with loss in dBm or DENIED
+	/// @param params Model and link budget to use
+	void compute(Point* tower, vector<Point*>& receivers, double* results, ModelParams* params);
+
+	/// Calculate the loss from the tower to every receiver in the list for each of the given parameter sets, resolving each path only once.  See modelLossTable() for how parameter sets share a path.
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param receivers List of destination points, each with towerHeight set
+	/// @param results Output table with one row per receiver and one column per parameter set, filled with loss in dBm or DENIED
+	/// @param params Array of parameter sets to evaluate
+	/// @param count Number of parameter sets
+	void compute(Point* tower, vector<Point*>& receivers, double* results, ModelParams* params, int count);
+
+	/// Calculate the loss from the tower to every receiver in the list, reusing attenuation from an earlier calculation that differed only in transmitter power or antenna gain.  New calculations are run with 1mW and no antenna gain and stored in the cache, and the link budget is added back with applyBudget(), so results match compute() exactly.
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param receivers List of destination points, each with towerHeight set
+	/// @param results Output array with room for one value per receiver, filled with loss in dBm or DENIED
+	/// @param params Model and link budget to use
+	/// @param cache Cache to check first and fill after calculating
+	void compute(Point* tower, vector<Point*>& receivers, double* results, ModelParams* params, LossCache* cache);
+
+	/// Find the best server and its signal to interference ratio at every receiver in the list, across many transmitters in a single pass.  Every tower and receiver is resolved only once, and each worker calculates every transmitter for one receiver before moving on, so terrain around the receivers stays in the caches.  Interference is the sum of every other signal on exactly the same frequency as the best server.
+	/// @param transmitters Every transmitter to consider, each with its own model and link budget
+	/// @param receivers List of destination points, each with towerHeight set
+	/// @param results Output array with room for one result per receiver
+	void computeServers(vector<Transmitter>& transmitters, vector<Point*>& receivers, BestServer* results);
+
+	/// Describe every parameter that changes the attenuation from the tower to the receivers, for use as a LossCache key.  The sampling mode of our sources and the terrain layers paths consider are part of the key, but the terrain itself isn't, so caches kept on disk must be cleared when the data changes.
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param receivers List of destination points, each with towerHeight set
+	/// @param params Model to use, its txPower and antenna are ignored
+	/// @return Unique description of this calculation
+	string cacheKey(Point* tower, vector<Point*>& receivers, ModelParams* params);
+
+	/// Calculate the loss from the tower to every point of a grid across the given area.
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param area Area to cover with receivers
+	/// @param gridResolution Spacing between receivers, in kilometers
+	/// @param rxHeight Height of each receiver, in meters
+	/// @param receivers Output list of receivers that were created, owned by the caller
+	/// @param params Model and link budget to use
+	/// @return Newly allocated array with one loss value per receiver, owned by the caller
+	double* compute(Point* tower, RegionArea* area, double gridResolution, double rxHeight, vector<Point*>& receivers, ModelParams* params);
+
+	/// Calculate the loss from the tower to every point of a region, creating receivers a batch at a time instead of keeping a Point for each.  Results match compute() over the points of region->discrete(), without ever holding more than COVERAGE_BATCH receivers.
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param range Points to calculate, from Region::range()
+	/// @param rxHeight Height of each receiver, in meters
+	/// @param results Output array with room for count results per point, laid out like compute()
+	/// @param params Array of parameter sets to evaluate
+	/// @param count Number of parameter sets
+	void compute(Point* tower, DiscreteRange* range, double rxHeight, double* results, ModelParams* params, int count);
+
+	/// Calculate the loss from the tower to every point of a grid, streaming results into a raster instead of keeping every receiver around.  Receivers are created and calculated a band of rows at a time, so memory stays bounded however large the grid, and each finished band is written by the raster's own thread while the next band is calculated.
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param grid Receivers to calculate, usually RasterGrid(area, gridResolution, count)
+	/// @param rxHeight Height of each receiver, in meters
+	/// @param params Array of parameter sets, one per band of the raster
+	/// @param count Number of parameter sets, which must match grid.bands
+	/// @param raster Open raster to fill, created with the same grid
+	void compute(Point* tower, RasterGrid& grid, double rxHeight, ModelParams* params, int count, RasterWriter* raster);
+
+	/// Calculate a single shard of a run split across several processes, writing its rows into a partial raster and then its manifest.  Every shard can run on its own, in any order and on any machine sharing the same files, and a shard that already finished with the same settings is skipped, so an interrupted run can simply be started again.  Cells match compute() into a raster of plan.grid, and shardMerge() stitches the shards together afterwards.
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param plan Split of the region, created the same way by every process
+	/// @param shard Index of the shard to calculate
+	/// @param rxHeight Height of each receiver, in meters
+	/// @param params Array of parameter sets, one per band of the raster
+	/// @param count Number of parameter sets, which must match plan.grid.bands
+	/// @param prefix Prefix shared by every file of the run, see shardPartial() and shardManifest()
+	/// @return True if the shard finished, now or in an earlier run
+	bool computeShard(Point* tower, ShardPlan& plan, int shard, double rxHeight, ModelParams* params, int count, string prefix);
+
+	/// Calculate the loss from the tower to every point of a grid across the given area using a radial sweep.  Rays are cast from the tower with angular steps fine enough to hit every grid cell, each ray's terrain profile is resolved only once, and every receiver takes the loss of the nearest sample on the nearest ray.  A running maximum of the ground's slope along each ray denies receivers that are clearly out of sight without walking their path, so only receivers in sight pay for the walk.  The txHeight and rxHeight overrides of params are honored like compute() does.  Only MODEL_KNIFE is swept, other models fall back to compute().
+	/// @param tower Signal origin point, with towerHeight set
+	/// @param area Area to cover with receivers
+	/// @param gridResolution Spacing between receivers, in kilometers
+	/// @param rxHeight Height of each receiver, in meters
+	/// @param receivers Output list of receivers that were created, owned by the caller
+	/// @param params Model and link budget to use
+	/// @return Newly allocated array with one loss value per receiver, owned by the caller
+	double* sweep(Point* tower, RegionArea* area, double gridResolution, double rxHeight, vector<Point*>& receivers, ModelParams* params);
+};
+
+
+/// Calculate a Z-order (Morton) visiting order for the given list of points, so that points close to each other on the ground are also close in the returned order.
+/// @param list List of points to order
+/// @param order Output array with room for one index per point, filled with indexes into list
+void zorder(vector<Point*>& list, long* order);
+
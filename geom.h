@@ -84,19 +84,64 @@ public:
 	/// @param distance Distance to walk along bearing line in kilometers
 	/// @return New point object after walking given distance along the bearing line.
 	Point* project(double bearing, double distance);
+	
+	/// Project this point along the given bearing line for the given distance, without creating a new point.
+	/// @param bearing Bearing to follow from this point in radians (range 0 to 2\pi)
+	/// @param distance Distance to walk along bearing line in kilometers
+	/// @param _lat Output latitude after walking given distance along the bearing line
+	/// @param _lon Output longitude after walking given distance along the bearing line
+	void project(double bearing, double distance, double* _lat, double* _lon);
+	
+	/// Project this point along the given bearing line at many evenly spaced distances at once.  Trig of this point and the bearing is only evaluated once, and each step rotates the previous one instead of starting over.  Every eighth point is projected exactly like project() at the same running distance, and the ones between stay within 20 nanometers of it.
+	/// @param bearing Bearing to follow from this point in radians (range 0 to 2\pi)
+	/// @param step Distance between projected points in kilometers, the first one sitting on this point
+	/// @param count Number of points to project
+	/// @param _lat Output array with room for count latitudes
+	/// @param _lon Output array with room for count longitudes
+	void projectList(double bearing, double step, int count, double* _lat, double* _lon);
 
 };
 
 
 
+/// Points between checkpoints kept by LineRange, and points generated at a time by discrete()
+#define DISCRETE_CHUNK 4096
+
+
+/// Coordinates of the discrete points of a region, generated on demand instead of kept as one Point each.  Any span of points can be generated in any order, so work can be split by index across threads, and memory stays flat however many points the region holds.
+class DiscreteRange {
+public:
+	virtual ~DiscreteRange() {}
+	
+	/// Count the points in this range.
+	/// @return Total number of points
+	virtual long count() = 0;
+	
+	/// Find the coordinates of consecutive points, exactly matching the points discrete() would create.  Safe to call from multiple threads at once.
+	/// @param start Index of the first point
+	/// @param n Number of points wanted
+	/// @param _lat Output array with room for n latitudes
+	/// @param _lon Output array with room for n longitudes
+	/// @return Number of points filled, fewer than n only at the end of the range
+	virtual int fill(long start, int n, double* _lat, double* _lon) = 0;
+};
+
+
 /// Define a generic region on the Earth.  Can turn its defined region into a series of discrete points, and check if a given point is inside the region.
 class Region {
 public:
+	virtual ~Region() {}
+	
 	/// Turn the defined region into a discrete set of points, using resolution to describe the level of detail.
 	/// @param resolution Level of spacing (detail) between the discrete points to be created.  Value in kilometers.
 	/// @return List of points that describe this region using the level of resolution requested
 	virtual vector<Point*> discrete(double resolution) = 0;
 	
+	/// Describe the same points as discrete(), without creating any of them.
+	/// @param resolution Level of spacing (detail) between the discrete points.  Value in kilometers.
+	/// @return Newly allocated range, owned by the caller
+	virtual DiscreteRange* range(double resolution) = 0;
+	
 	/// Check if this region contains the given point.
 	/// @param p Point to check against
 	/// @return True if point is inside this region, false otherwise
@@ -138,6 +183,11 @@ public:
 	/// @return List of points that describe this region using the level of resolution requested
 	vector<Point*> discrete(double resolution);
 	
+	/// Describe the same grid as discrete(), without creating any points.
+	/// @param resolution Level of spacing (detail) between the discrete points.  Value in kilometers.
+	/// @return Newly allocated AreaRange, owned by the caller
+	DiscreteRange* range(double resolution);
+	
 	/// Check if this region contains the given point.
 	/// @param p Point to check against
 	/// @return True if point is inside this region, false otherwise
@@ -157,6 +207,8 @@ class RegionLine : Region {
 private:
 	/// List of all points contained in this linear region
 	vector<Point*> list;
+	/// True if the points were read from a file, and are deleted along with the line
+	bool owned;
 public:
 	RegionLine();
 	
@@ -184,6 +236,11 @@ public:
 	/// @return List of points that describe this region using the level of resolution requested
 	vector<Point*> discrete(double resolution);
 	
+	/// Describe the same steps as discrete(), without creating any points.
+	/// @param resolution Level of spacing (detail) between the discrete points.  Value in kilometers.
+	/// @return Newly allocated LineRange, owned by the caller
+	DiscreteRange* range(double resolution);
+	
 	/// Check if this region contains the given point.  Always returns false for line segments.
 	/// @param p Point to check against
 	/// @return Always returns false.
@@ -196,3 +253,115 @@ public:
 };
 
 
+
+/// Grid of points across a RegionArea, generated on demand.  Only the latitude of each row and longitude of each column are kept.
+class AreaRange : public DiscreteRange {
+public:
+	/// Latitude of each row from the bottom up, and longitude of each column from left to right
+	vector<double> lats, lons;
+	/// Spacing between rows and columns, in degrees
+	double step;
+	
+	/// Step across the area exactly like RegionArea::discrete().
+	/// @param area Area to cover
+	/// @param resolution Spacing between points, in kilometers
+	AreaRange(RegionArea* area, double resolution);
+	
+	long count();
+	
+	int fill(long start, int n, double* _lat, double* _lon);
+};
+
+
+/// Steps along a RegionLine, generated on demand.  Keeps each segment of the line, and the running distance every DISCRETE_CHUNK points, so any point can be found without walking the whole line.
+class LineRange : public DiscreteRange {
+private:
+	double resolution;
+	long total;
+	/// Start, bearing and length of each segment, and distance along the line to its start
+	vector<Point> starts;
+	vector<double> bearings, distances, offsets;
+	/// Distance along the line, and segment, of every DISCRETE_CHUNK-th point
+	vector<double> marks;
+	vector<int> markSegments;
+	
+public:
+	/// Step along the line exactly like RegionLine::discrete().
+	/// @param list Points describing the line
+	/// @param _resolution Spacing between points, in kilometers
+	LineRange(vector<Point*>& list, double _resolution);
+	
+	long count();
+	
+	int fill(long start, int n, double* _lat, double* _lon);
+};
+
+
+
+/// Terrain sampled in even steps along a line, stored as one array per field instead of one Point per sample.  Meant to be reused for many paths, so once it has grown large enough, building and resolving a path allocates nothing.
+class TerrainProfile {
+private:
+	/// Room allocated in each column
+	int capacity;
+	
+	/// Make sure each column has room for at least the given number of samples.  Existing contents are not kept.
+	void reserve(int size);
+	
+	/// Every profile owns its columns, so profiles are never copied.  Left unimplemented on purpose.
+	TerrainProfile(const TerrainProfile&);
+	TerrainProfile& operator=(const TerrainProfile&);
+	
+public:
+	/// Number of samples currently held
+	int count;
+	/// Spacing between samples, in kilometers
+	double resolution;
+	/// Latitude of each sample
+	double* lat;
+	/// Longitude of each sample
+	double* lon;
+	/// Distance of each sample from the start of the line, in kilometers
+	double* distance;
+	/// Elevation of each sample, stored two slots into pfl
+	double* elev;
+	/// Height of vegetation above ground at each sample
+	double* vegHeight;
+	/// Vegetation type at each sample
+	int* vegType;
+	/// Vegetation cover percentage at each sample
+	int* vegCover;
+	/// Land use type at each sample
+	int* landType;
+	/// Elevations prefixed with the number of steps and the step size in meters, ready to pass directly to point_to_point()
+	double* pfl;
+	
+	TerrainProfile();
+	
+	~TerrainProfile();
+	
+	/// Fill with samples stepping from p towards q in resolution-length steps, matching the points returned by RegionLine(p, q).discrete(resolution) to within 20 nanometers, see Point::projectList().  Data columns are reset to the same defaults as a new Point.  A resolution that isn't a positive finite number, or one so fine the samples wouldn't fit in an int, leaves the profile empty.
+	/// @param p Starting point for the line
+	/// @param q Ending point for the line
+	/// @param _resolution Spacing between samples, in kilometers
+	void line(Point* p, Point* q, double _resolution);
+	
+	/// Fill with samples stepping out from p along the given bearing.  Data columns are reset to the same defaults as a new Point.
+	/// @param p Starting point for the ray
+	/// @param bearing Bearing to follow from p in radians
+	/// @param _count Number of samples to take, the first one sitting on p, where anything below zero leaves the profile empty
+	/// @param _resolution Spacing between samples, in kilometers
+	void ray(Point* p, double bearing, int _count, double _resolution);
+	
+	/// Copy a single sample into the given Point, so it can be handed to code that works on points.
+	/// @param index Sample to copy
+	/// @param r Point to fill with the sample location and data
+	void load(int index, Point* r);
+	
+	/// Copy data from the given Point back into a single sample.
+	/// @param index Sample to overwrite
+	/// @param r Point holding the data to keep
+	void store(int index, Point* r);
+	
+};
+
+
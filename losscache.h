@@ -0,0 +1,106 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <list>
+#include <map>
+
+#include <pthread.h>
+
+using namespace std;
+
+#define LOSSCACHE_MAGIC "LPLOSS1"
+
+
+/// Cache of path attenuation for whole coverage calculations, so the same coverage can be shown again with a new transmitter power, antenna gain or receiver sensitivity without walking any paths.  Both propagation models only add the link budget at the very end, so attenuation is stored with the budget left out and applyBudget() adds it back exactly.  Entries live in memory up to a budget, and are optionally also written to a directory so other processes and later runs can find them.
+class LossCache {
+private:
+	/// Attenuation for every receiver of a single calculation
+	struct Entry {
+		string key;
+		double* attenuation;
+		long count;
+	};
+
+	pthread_mutex_t lock;
+	/// Entries from most to least recently used
+	list<Entry*> recent;
+	map<string, list<Entry*>::iterator> lookup;
+	/// Memory budget for attenuation values, and memory currently used, in bytes
+	long budget, bytes;
+	/// Directory entries are spilled to, or empty to keep them in memory only
+	string directory;
+
+	long hitCount, missCount, diskCount;
+
+	/// Filename holding the given key inside our directory.
+	string path(string& key);
+
+	/// Read the given key from our directory.
+	/// @return Newly allocated entry, or NULL if it isn't on disk
+	Entry* load(string& key, long count);
+
+	/// Write the given entry to our directory, replacing any older copy.
+	void save(Entry* entry);
+
+	/// Add a new entry to memory, evicting the least recently used entries to stay under budget.  Called with the lock held.
+	void insert(Entry* entry);
+
+public:
+	/// Create a new loss cache.
+	/// @param _budget Maximum memory to use for attenuation values, in bytes
+	/// @param _directory Existing directory to spill entries into, or empty to keep them in memory only
+	LossCache(long _budget, string _directory = "");
+
+	~LossCache();
+
+	/// Find the attenuation stored under the given key, checking memory first and then our directory.  Safe to call from multiple threads at once.
+	/// @param key Description of every parameter that changes attenuation, such as from Coverage::cacheKey()
+	/// @param attenuation Output array with room for count values
+	/// @param count Number of values expected under this key
+	/// @return True if the key was found with exactly count values
+	bool find(string key, double* attenuation, long count);
+
+	/// Remember the given attenuation under the given key.  Safe to call from multiple threads at once.
+	/// @param key Description of every parameter that changes attenuation
+	/// @param attenuation Array of count values, as filled by a calculation with 1mW of power and no antenna gain
+	/// @param count Number of values
+	void store(string key, double* attenuation, long count);
+
+	/// Number of find() calls answered from memory or disk.
+	long hits();
+
+	/// Number of find() calls that found nothing.
+	long misses();
+
+	/// Number of find() calls answered by reading our directory.
+	long diskHits();
+};
+
+
+/// Turn losses calculated with 1mW of power and no antenna gain into losses for the given link budget.  Gives exactly the same values as calculating with that budget directly.
+/// @param attenuation Array of losses calculated with txPower 1 and antenna 0, in dBm or DENIED
+/// @param count Number of values
+/// @param txPower Transmitter power, in mW
+/// @param antenna Total antenna gain of both receiver and transmitter, in dB
+/// @param results Output array with room for count values, filled with loss in dBm or DENIED.  May be the same array as attenuation.
+void applyBudget(double* attenuation, long count, double txPower, double antenna, double* results);
+
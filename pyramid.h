@@ -0,0 +1,85 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define PYRAMID_MAGIC "LPPYR1"
+/// Finest level kept, as a power of two: blocks on the finest level cover 4 by 4 cells
+#define PYRAMID_BASE 2
+
+
+/// Smallest and largest value inside square blocks of a grid, at every power of two block size up to the whole grid.  Lets path walks prove that terrain stays clear of, or blocks, the line of sight without reading every cell along the path.
+class ElevationPyramid {
+private:
+	int ncols, nrows;
+	/// Width and height of each level, in blocks, finest level first
+	vector<int> widths, heights;
+	/// Smallest and largest value of each block on each level, in rows counting from the top
+	vector<float*> lows, highs;
+
+	/// Size every level for our grid and allocate its blocks.
+	void allocate();
+
+public:
+	/// Create an empty pyramid, ready to be filled one row at a time.
+	/// @param _ncols Number of columns in the grid
+	/// @param _nrows Number of rows in the grid
+	ElevationPyramid(int _ncols, int _nrows);
+
+	~ElevationPyramid();
+
+	/// Fold a single row of the grid into the finest level.  Every row must be added once before calling finish().
+	/// @param row Index of the row, counting from the top
+	/// @param values Every value in the row, NaN values are treated as unbounded
+	void addRow(int row, const float* values);
+
+	/// Build every coarser level from the finest one.
+	void finish();
+
+	/// Find bounds on every cell inside the given rectangle of cells.  Bounds come from the coarsest level needed to cover the rectangle with at most two by two blocks, so they may be looser than the true smallest and largest value.
+	/// @param row0 First row of the rectangle, counting from the top
+	/// @param col0 First column of the rectangle
+	/// @param row1 Last row of the rectangle, inclusive
+	/// @param col1 Last column of the rectangle, inclusive
+	/// @param low Output value no larger than any cell in the rectangle
+	/// @param high Output value no smaller than any cell in the rectangle
+	void bounds(int row0, int col0, int row1, int col1, double* low, double* high);
+
+	/// Write this pyramid to disk, tagged with the size and modification time of the grid it was built from.  Values are kept in native byte order, since pyramids are cheap to rebuild on another machine.
+	/// @param filename File to create or replace
+	/// @param size Size of the grid data file, in bytes
+	/// @param modified Modification time of the grid data file
+	/// @return True if the whole pyramid was written
+	bool write(string filename, long size, long modified);
+
+	/// Read a pyramid written by write(), as long as it still matches the grid it was built from.
+	/// @param filename File to read
+	/// @param _ncols Number of columns expected
+	/// @param _nrows Number of rows expected
+	/// @param size Size of the grid data file, in bytes
+	/// @param modified Modification time of the grid data file
+	/// @return Newly allocated pyramid, or NULL if the file is missing, damaged or stale
+	static ElevationPyramid* read(string filename, int _ncols, int _nrows, long size, long modified);
+};
+
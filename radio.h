@@ -31,6 +31,15 @@
 #define CONSIDER_VEG true
 #define CONSIDER_LAND true
 
+/// Loss terms a knife-edge walk can add on top of free space and diffraction, combined into a mask that picks the compiled walk to run
+#define TERM_VEG 1
+#define TERM_LAND 2
+/// Score fresnel zone violations with calcFresnelLoss() instead of knifeEdgeLoss()
+#define TERM_FRESNEL 4
+
+/// Samples bounded together when culling a knife-edge path, no more than CONVERT_CHUNK
+#define CULL_SAMPLES 32
+
 /// Calculate the knife-edge loss given the situation variables.
 /// @param startY Signal origin elevation point, in meters
 /// @param endY Signal end elevation point, in meters
@@ -43,6 +52,12 @@
 /// @return Calculated loss as provided by knife-edge diffraction model, in dBm
 double knifeEdgeLoss(double startY, double endY, double pointY, double distX, double dist1X, double dist2X, double lambda, double sight);
 
+/// Calculate the knife-edge loss from how much longer the path bent over an obstruction is than the direct path.  Loss only grows with the difference, so the worst of many obstructions is simply the one with the largest difference.
+/// @param deltaD Length of the path over the obstruction minus the direct path, in meters
+/// @param lambda Lambda value calculated using signal frequency
+/// @return Calculated loss as provided by knife-edge diffraction model, in dBm
+double knifeEdgeDeltaLoss(double deltaD, double lambda);
+
 /// Calculate the fresnel loss given the situation variables.  This model was found in literature, but seems less reliable.
 /// @param ground Elevation of ground at current point, in meters
 /// @param sight Imaginary elevation of line-of-sight between origin and end point, in meters
@@ -70,6 +85,132 @@ double calcLandLoss(int type, double distance, double freq);
 /// @return Calculated loss along given path, in dBm
 double pathLoss(Point* p, Point* q, SourceGroup* s, double resolution, double txPower, double antenna, double freq);
 
+/// Calculate the loss if we follow a given path between two radio towers, using the given profile as scratch space.  Reusing one profile per thread avoids allocating anything for each path.
+/// @param p Signal origin point, with towerHeight set
+/// @param q Signal destination point, with towerHeight set
+/// @param s SourceGroup to provide elevation and vegetaion data as required
+/// @param profile Scratch profile to fill with the path, overwritten by this call
+/// @param resolution Detail used to step along the line-of-sight path, in kilometers
+/// @param txPower Transmitter power, in mW
+/// @param antenna Total antenna gain of both receiver and transmitter, in dB
+/// @param freq Frequency that radios operate at, in MHz
+/// @return Calculated loss along given path, in dBm
+double pathLoss(Point* p, Point* q, SourceGroup* s, TerrainProfile* profile, double resolution, double txPower, double antenna, double freq);
+
+
+/// Check if the destination lies beyond the radio horizon of the origin, in which case the knife-edge model denies the path outright.
+/// @param p Signal origin point, with towerHeight set and already resolved
+/// @param q Signal destination point
+/// @return True if q is farther away than the radio horizon of p
+bool beyondHorizon(Point* p, Point* q);
+
+
+/// Calculate the loss along a path whose samples have already been discretized and resolved.  This is the walk used by pathLoss(), and lets callers share one resolved terrain profile between many receivers.
+/// @param p Signal origin point, with towerHeight set and already resolved
+/// @param q Signal destination point, with towerHeight set and already resolved
+/// @param profile Resolved samples stepping from p towards q
+/// @param count Number of samples from the start of profile that lie between p and q
+/// @param txPower Transmitter power, in mW
+/// @param antenna Total antenna gain of both receiver and transmitter, in dB
+/// @param freq Frequency that radios operate at, in MHz
+/// @return Calculated loss along given path, in dBm
+double pathLossWalk(Point* p, Point* q, TerrainProfile* profile, int count, double txPower, double antenna, double freq);
+
+/// Calculate the loss along a resolved path with only the given loss terms.  Each mask runs its own compiled walk, so terms that are left out cost nothing per sample.  Leaving out vegetation or land use gives exactly the same result as including them over samples that never had those layers resolved.
+/// @param p Signal origin point, with towerHeight set and already resolved
+/// @param q Signal destination point, with towerHeight set and already resolved
+/// @param profile Resolved samples stepping from p towards q
+/// @param count Number of samples from the start of profile that lie between p and q
+/// @param txPower Transmitter power, in mW
+/// @param antenna Total antenna gain of both receiver and transmitter, in dB
+/// @param freq Frequency that radios operate at, in MHz
+/// @param terms Mask of TERM_VEG and friends to include
+/// @return Calculated loss along given path, in dBm
+double pathLossWalk(Point* p, Point* q, TerrainProfile* profile, int count, double txPower, double antenna, double freq, int terms);
+
+/// Pick the loss terms worth walking for the given sources: vegetation and land use are only included when CONSIDER_VEG or CONSIDER_LAND asks for them and the group actually holds that layer.
+/// @param s SourceGroup that will resolve the path
+/// @return Mask of TERM_VEG and friends
+int pathLossTerms(SourceGroup* s);
+
+/// Find the layers a walk with the given loss terms reads from its profile.
+/// @param terms Mask of TERM_VEG and friends
+/// @return Mask of LAYER_ELEV and friends to resolve
+int pathLossLayers(int terms);
+
+/// Calculate the knife-edge loss along a path whose samples have been discretized but not resolved, giving exactly the same result as resolving every sample and calling pathLossWalk().  Only the layers picked by pathLossTerms() are resolved.  Runs of samples are first checked against elevation bounds from the sources: a path that must be blocked is denied without reading any terrain, and samples that must stay clear of the first fresnel zone are never resolved.  Only samples the bounds can't settle are read.
+/// @param p Signal origin point, with towerHeight set and already resolved
+/// @param q Signal destination point, with towerHeight set and already resolved
+/// @param s SourceGroup to provide elevation bounds and data as required
+/// @param profile Samples stepping from p towards q, as filled by TerrainProfile::line().  Samples that were never resolved are left with an elevation of -INFINITY, so the profile can't be reused for another model afterwards.
+/// @param txPower Transmitter power, in mW
+/// @param antenna Total antenna gain of both receiver and transmitter, in dB
+/// @param freq Frequency that radios operate at, in MHz
+/// @return Calculated loss along given path, in dBm
+double pathLossCulled(Point* p, Point* q, SourceGroup* s, TerrainProfile* profile, double txPower, double antenna, double freq);
+
+
+/// Ground and atmosphere settings handed to the Longley-Rice model.
+class LongleySettings {
+public:
+	/// Dielectric constant of the ground
+	double dielectric;
+	/// Conductivity of the ground, in siemens per meter
+	double conductivity;
+	/// Surface refractivity of the atmosphere, in N-units
+	double refractivity;
+	/// Enumeration of radio climate, 1 through 7
+	int climate;
+	/// Polarization, 0 for horizontal or 1 for vertical
+	int polarization;
+	/// Fraction of time the loss is not exceeded
+	double conf;
+	/// Fraction of situations the loss is not exceeded
+	double rel;
+	
+	/// Create settings for average ground, average atmosphere, continental temperate climate, horizontal polarization, and 90% time and situation variability.
+	LongleySettings();
+};
+
+
+/// Number of avar() coefficients kept by LongleyModel
+#define LONGLEY_TERMS 25
+
+/// Everything the Longley-Rice model works out from its settings and frequency alone, prepared once and shared by every path that uses them.  Only the terrain dependent parts are left to run for each path, with results identical to point_to_point().
+class LongleyModel {
+public:
+	/// Settings and frequency this model was prepared for
+	LongleySettings settings;
+	double freq;
+	/// Wave number, and surface transfer impedance of the ground for our polarization, from qlrps()
+	double wn, zgndReal, zgndImag;
+	/// Standard normal deviates for situation and time variability, from qerfi()
+	double zc, zr;
+	/// Part of the free space loss that doesn't depend on distance
+	double fsBase;
+	/// Climate curve coefficients from the first avar() call
+	double terms[LONGLEY_TERMS];
+	/// Variability mode from the first avar() call
+	int kdv;
+	bool ws, w1;
+	/// Error code raised by the settings alone, such as an unknown climate
+	int kwx;
+	
+	/// Create an empty model, which matches no settings.
+	LongleyModel();
+	
+	/// Prepare the model for the given settings and frequency.
+	/// @param _settings Ground and atmosphere settings to use
+	/// @param _freq Frequency that radios operate at, in MHz
+	LongleyModel(LongleySettings* _settings, double _freq);
+	
+	/// Check if this model was prepared for the given settings and frequency.
+	/// @param _settings Ground and atmosphere settings to check
+	/// @param _freq Frequency to check, in MHz
+	/// @return True if every setting matches exactly
+	bool matches(LongleySettings* _settings, double _freq);
+};
+
 
 /// Calculate the loss if we follow a given path between two radio towers.  Uses Longley-Rice propagation model to calculate attenuation.
 /// @param p Signal origin point, with towerHeight set
@@ -81,3 +222,77 @@ double pathLoss(Point* p, Point* q, SourceGroup* s, double resolution, double tx
 /// @param freq Frequency that radios operate at, in MHz
 /// @return Calculated loss along given path, in dBm
 double pathLossLongley(Point* p, Point* q, SourceGroup* s, double resolution, double txPower, double antenna, double freq);
+
+/// Calculate the loss if we follow a given path between two radio towers, using the given profile as scratch space.  Uses Longley-Rice propagation model to calculate attenuation, handing it the profile elevations without copying them.
+/// @param p Signal origin point, with towerHeight set
+/// @param q Signal destination point, with towerHeight set
+/// @param s SourceGroup to provide elevation and vegetaion data as required
+/// @param profile Scratch profile to fill with the path, overwritten by this call
+/// @param resolution Detail used to step along the line-of-sight path, in kilometers
+/// @param txPower Transmitter power, in mW
+/// @param antenna Total antenna gain of both receiver and transmitter, in dB
+/// @param freq Frequency that radios operate at, in MHz
+/// @return Calculated loss along given path, in dBm
+double pathLossLongley(Point* p, Point* q, SourceGroup* s, TerrainProfile* profile, double resolution, double txPower, double antenna, double freq);
+
+
+/// Run the Longley-Rice point-to-point model over a single elevation profile.  Keeps all state in local variables, so it can be called from many threads at once.
+/// @param elev Elevation profile in the form [num points - 1], [delta dist (meters)], [height (meters) point 1], ..., [height (meters) point n]
+/// @param tht_m Transmitter height above ground, in meters
+/// @param rht_m Receiver height above ground, in meters
+/// @param eps_dielect Dielectric constant of the ground
+/// @param sgm_conductivity Conductivity of the ground
+/// @param eno_ns_surfref Surface refractivity of the atmosphere
+/// @param frq_mhz Frequency that radios operate at, in MHz
+/// @param radio_climate Enumeration of radio climate (1-7)
+/// @param pol Polarization, 0 for horizontal, 1 for vertical
+/// @param conf Confidence variability (0.01 to 0.99)
+/// @param rel Time variability (0.01 to 0.99)
+/// @param dbloss Output calculated loss, in dB
+/// @param strmode Output string describing the propagation mode used
+/// @param errnum Output error code, 0 if parameters were all in range
+void point_to_point(double elev[], double tht_m, double rht_m, double eps_dielect, double sgm_conductivity, double eno_ns_surfref, double frq_mhz, int radio_climate, int pol, double conf, double rel, double &dbloss, char *strmode, int &errnum);
+
+/// Work out every part of the Longley-Rice point-to-point model that doesn't depend on the terrain.  See point_to_point() for parameters.
+/// @param model Output model, ready for point_to_point_prepared()
+void point_to_point_prepare(double eps_dielect, double sgm_conductivity, double eno_ns_surfref, double frq_mhz, int radio_climate, int pol, double conf, double rel, LongleyModel &model);
+
+/// Run the Longley-Rice point-to-point model over a single elevation profile, using settings already prepared by point_to_point_prepare().  Gives exactly the same loss and error code as point_to_point().
+/// @param elev Elevation profile, in the same form taken by point_to_point()
+/// @param tht_m Transmitter height above ground, in meters
+/// @param rht_m Receiver height above ground, in meters
+/// @param model Prepared settings and frequency
+/// @param dbloss Output calculated loss, in dB
+/// @param errnum Output error code, 0 if parameters were all in range
+void point_to_point_prepared(double elev[], double tht_m, double rht_m, const LongleyModel &model, double &dbloss, int &errnum);
+
+/// Run the Longley-Rice point-to-point model over many elevation profiles that share the same settings, which are only prepared once.
+/// @param elevs List of elevation profiles, each in the same form taken by point_to_point()
+/// @param count Number of elevation profiles
+/// @param dbloss Output array filled with calculated loss for each profile, in dB
+/// @param errnum Output array filled with error code for each profile
+void point_to_point_batch(double *elevs[], int count, double tht_m, double rht_m, double eps_dielect, double sgm_conductivity, double eno_ns_surfref, double frq_mhz, int radio_climate, int pol, double conf, double rel, double dbloss[], int errnum[]);
+
+
+/// Calculate the Longley-Rice loss along a path whose samples have already been discretized and resolved.  Lets callers evaluate many settings over one resolved terrain profile.
+/// @param p Signal origin point, with towerHeight set
+/// @param q Signal destination point, with towerHeight set
+/// @param profile Resolved samples stepping from p towards q
+/// @param settings Ground and atmosphere settings to use
+/// @param txPower Transmitter power, in mW
+/// @param antenna Total antenna gain of both receiver and transmitter, in dB
+/// @param freq Frequency that radios operate at, in MHz
+/// @return Calculated loss along given path, in dBm, or DENIED
+double pathLossLongleyProfile(Point* p, Point* q, TerrainProfile* profile, LongleySettings* settings, double txPower, double antenna, double freq);
+
+/// Calculate the Longley-Rice loss along a path whose samples have already been discretized and resolved, using a model prepared ahead of time.
+/// @param p Signal origin point, with towerHeight set
+/// @param q Signal destination point, with towerHeight set
+/// @param profile Resolved samples stepping from p towards q
+/// @param model Settings and frequency, already prepared
+/// @param txPower Transmitter power, in mW
+/// @param antenna Total antenna gain of both receiver and transmitter, in dB
+/// @return Calculated loss along given path, in dBm, or DENIED
+double pathLossLongleyProfile(Point* p, Point* q, TerrainProfile* profile, LongleyModel* model, double txPower, double antenna);
+
+
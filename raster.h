@@ -0,0 +1,172 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <deque>
+
+#include <pthread.h>
+
+using namespace std;
+
+#include "geom.h"
+
+#define RASTER_MAGIC "LPRAST1"
+
+/// Plain header followed by the grid, see RasterHeader
+#define RASTER_NATIVE 0
+/// Uncompressed single-strip GeoTIFF, readable by GDAL and most GIS tools
+#define RASTER_GEOTIFF 1
+
+/// Bytes of queued cells allowed before writing threads wait for the disk to catch up
+#define RASTER_QUEUE (16 * 1024 * 1024)
+/// Receivers created and calculated at a time when streaming a coverage into a raster
+#define RASTER_BAND_CELLS 65536
+
+
+/// Layout of a regular grid of receivers.  Cells are stored in rows from the top down, each cell holding one float32 value per band.
+class RasterGrid {
+public:
+	int ncols, nrows;
+	/// Number of values stored for each cell
+	int bands;
+	/// Longitude of the left column and latitude of the bottom row
+	double left, bottom;
+	/// Distance between neighboring columns and rows, in degrees
+	double stepLon, stepLat;
+
+	/// Create an empty grid.
+	RasterGrid();
+
+	/// Create a grid holding exactly the receivers RegionArea::discrete() would create.
+	/// @param area Area to cover
+	/// @param resolution Spacing between receivers, in kilometers
+	/// @param _bands Number of values stored for each receiver
+	RasterGrid(RegionArea* area, double resolution, int _bands);
+
+	/// Find the latitude of every row from the bottom up, stepping exactly like RegionArea::discrete() so receivers land on the same coordinates.
+	/// @param lats Output array with room for nrows values
+	void latitudes(double* lats);
+
+	/// Find the longitude of every column from left to right, stepping exactly like RegionArea::discrete().
+	/// @param lons Output array with room for ncols values
+	void longitudes(double* lons);
+
+	/// Bytes needed for a single row.
+	long rowBytes();
+};
+
+
+/// Streaming writer of float32 rasters.  Cells can arrive in any order from any thread: each write() copies its cells into a queue and returns, and a background thread writes them into place with pwrite().  Only a bounded amount of data is ever queued, so huge rasters never live in memory.  Cells that are never written read back as zero.
+class RasterWriter {
+private:
+	/// Cells waiting to be written
+	struct Pending {
+		long offset;
+		char* data;
+		long length;
+	};
+
+	RasterGrid grid;
+	int fd;
+	/// Byte offset of the first cell
+	long dataOffset;
+
+	pthread_t writer;
+	pthread_mutex_t lock;
+	/// Signalled when cells are queued, or when closing
+	pthread_cond_t queued;
+	/// Signalled whenever queued bytes drop
+	pthread_cond_t drained;
+	deque<Pending> queue;
+	long queuedBytes;
+	bool stopping, failed, closed;
+
+	static void* main(void* data);
+
+	/// Write the header for the given format.
+	/// @return True if the header was written
+	bool writeHeader(int format);
+
+public:
+	/// Create a raster file and start its background writer thread.
+	/// @param filename File to create or replace
+	/// @param _grid Layout of the raster
+	/// @param format Either RASTER_NATIVE or RASTER_GEOTIFF
+	RasterWriter(string filename, RasterGrid& _grid, int format);
+
+	/// Closes the raster if close() hasn't been called already.
+	~RasterWriter();
+
+	/// Check that the file was created.
+	/// @return False if the file or its header couldn't be written
+	bool good();
+
+	/// Queue consecutive cells for writing.  Safe to call from multiple threads at once, and only blocks while too many cells are already queued.
+	/// @param cell Index of the first cell, counting across each row from the top left
+	/// @param values One value for every band of each cell
+	/// @param count Number of cells
+	void write(long cell, const float* values, long count);
+
+	/// Queue a single whole row for writing.
+	/// @param row Index of the row, counting from the top
+	/// @param values One value for every band of each cell in the row
+	void writeRow(int row, const float* values);
+
+	/// Wait for every queued cell to reach the file, and close it.
+	/// @return True if every cell was written
+	bool close();
+};
+
+
+/// Read the layout of a raster written by RasterWriter, in either format.
+/// @param filename Raster to read
+/// @param grid Output layout
+/// @param dataOffset Output byte offset of the first cell
+/// @return True if the file is a raster we can read
+bool rasterLayout(string filename, RasterGrid* grid, long* dataOffset);
+
+/// Read a single row of a raster.
+/// @param fd Raster opened for reading
+/// @param grid Layout from rasterLayout()
+/// @param dataOffset Byte offset of the first cell, from rasterLayout()
+/// @param row Index of the row, counting from the top
+/// @param values Output array with room for every band of each cell in the row
+/// @return True if the whole row was read
+bool rasterRow(int fd, RasterGrid& grid, long dataOffset, int row, float* values);
+
+/// Convert a raster into the text format written by main.C: one line of latitude, longitude, and every band for each cell, from the bottom row up, skipping cells whose first band is DENIED.
+/// @param filename Raster to read
+/// @param output Stream to write lines into
+/// @return True if the whole raster was read
+bool rasterText(string filename, ostream& output);
+
+/// Convert a single band of a raster into a PNG image, shaded like plot.C: cells weaker than the sensitivity or DENIED are transparent, others are the given color, more opaque for stronger signals.  Rows are encoded as they are read, so the image never lives in memory.
+/// @param filename Raster to read
+/// @param pngFilename Image to create or replace
+/// @param band Band to draw
+/// @param sens Receiver sensitivity, in dBm
+/// @param r Red part of the color
+/// @param g Green part of the color
+/// @param b Blue part of the color
+/// @return True if the whole image was written
+bool rasterPng(string filename, string pngFilename, int band, double sens, int r, int g, int b);
+
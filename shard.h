@@ -0,0 +1,141 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+#include "geom.h"
+#include "raster.h"
+
+#define SHARD_MAGIC "libprop-shard 1"
+
+
+/// Deterministic split of a region into shards that separate processes, or separate machines sharing the same data directory, can calculate on their own.  Shards are bands of neighboring raster rows, so each one stays close together on the ground, and the split only depends on the grid and the number of shards, so every process works it out the same way.
+class ShardPlan {
+public:
+	/// Layout of the merged raster.  Areas use RasterGrid(area, resolution, bands), routes use a single column with one row per point, the first point in the bottom row, and no coordinates of their own.
+	RasterGrid grid;
+	/// Number of shards the grid is split into
+	int shards;
+	/// Every point of the region, in the same order as discrete(), owned by the plan
+	DiscreteRange* range;
+
+	/// Split a grid of receivers across an area.
+	/// @param area Area to cover
+	/// @param resolution Spacing between receivers, in kilometers
+	/// @param bands Number of values stored for each receiver
+	/// @param _shards Number of shards to split into
+	ShardPlan(RegionArea* area, double resolution, int bands, int _shards);
+
+	/// Split the receivers along a route.
+	/// @param line Route to cover
+	/// @param resolution Spacing between receivers, in kilometers
+	/// @param bands Number of values stored for each receiver
+	/// @param _shards Number of shards to split into
+	ShardPlan(RegionLine* line, double resolution, int bands, int _shards);
+
+	~ShardPlan();
+
+	/// Find the raster rows covered by a shard.
+	/// @param shard Index of the shard, from 0 to shards - 1
+	/// @param first Output index of the first row, counting from the top
+	/// @param count Output number of rows
+	void rows(int shard, int* first, int* count);
+};
+
+
+/// Record of a finished shard, written beside its partial raster only once every cell has reached the disk.  A shard without a manifest never finished, and is calculated again from scratch.
+class ShardManifest {
+public:
+	int shard, shards;
+	/// Rows covered by the shard, counting from the top
+	int firstRow, rows;
+	/// Layout of the merged raster
+	RasterGrid grid;
+	/// Description of the tower, receivers and models, identical for every shard of the same run
+	string run;
+	/// crc32 of the values in the shard's rows, as read back from the partial raster
+	unsigned long crc;
+
+	ShardManifest();
+
+	/// Write the manifest beside its final name and rename it into place, so readers never see half a manifest.
+	/// @param filename Manifest to create or replace
+	/// @return True if the whole manifest was written
+	bool write(string filename);
+
+	/// Read a manifest written by write().
+	/// @param filename Manifest to read
+	/// @return True if the file is a complete manifest
+	bool read(string filename);
+
+	/// Check that another manifest describes the same shard of the same run.
+	/// @param other Manifest to compare against, its crc is ignored
+	/// @return True if everything but the crc matches
+	bool matches(ShardManifest& other);
+};
+
+
+/// Find the rows of a shard without a ShardPlan.  Rows are split as evenly as possible, in order from the top.
+/// @param nrows Number of rows in the whole grid
+/// @param shards Number of shards
+/// @param shard Index of the shard
+/// @param first Output index of the first row
+/// @param count Output number of rows
+void shardRows(int nrows, int shards, int shard, int* first, int* count);
+
+/// Name the partial raster of a shard.
+/// @param prefix Prefix shared by every file of the run
+/// @param shard Index of the shard
+/// @return Filename of the partial raster
+string shardPartial(string prefix, int shard);
+
+/// Name the manifest of a shard.
+/// @param prefix Prefix shared by every file of the run
+/// @param shard Index of the shard
+/// @return Filename of the manifest
+string shardManifest(string prefix, int shard);
+
+/// Checksum consecutive rows of a raster.
+/// @param filename Raster to read
+/// @param grid Layout the raster must have
+/// @param firstRow Index of the first row, counting from the top
+/// @param rows Number of rows
+/// @param crc Output crc32 of the rows
+/// @return True if the raster has the given layout and every row was read
+bool shardChecksum(string filename, RasterGrid& grid, int firstRow, int rows, unsigned long* crc);
+
+/// Check whether a shard already finished in an earlier run, so a restarted run can skip it.
+/// @param prefix Prefix shared by every file of the run
+/// @param expected Manifest the shard would write, its crc is ignored
+/// @return True if a matching manifest exists and its partial raster still has the same checksum
+bool shardFinished(string prefix, ShardManifest& expected);
+
+/// Stitch every shard of a run into a single raster.  Nothing is written unless every shard has a manifest from the same run, the shards cover every row of the grid exactly once, and every partial raster still matches its checksum.
+/// @param prefix Prefix shared by every file of the run
+/// @param output Raster to create or replace
+/// @param format Either RASTER_NATIVE or RASTER_GEOTIFF
+/// @param log Stream to describe missing or damaged shards, and the merged result
+/// @return True if the merged raster was written
+bool shardMerge(string prefix, string output, int format, ostream& log);
+
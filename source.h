@@ -24,17 +24,32 @@
 #include <string>
 
 #include <math.h>
+#include <pthread.h>
 
 using namespace std;
 
 #include "geom.h"
 #include "utils.h"
+#include "blockcache.h"
+#include "pyramid.h"
 
 #define TYPE_ELEV 2
 #define TYPE_VEGTYPE 3
 #define TYPE_VEGHEIGHT 4
 #define TYPE_LAND 5
 
+/// Bit for each type of data, combined into masks of the layers a caller wants resolved
+#define LAYER_ELEV (1 << TYPE_ELEV)
+#define LAYER_VEGTYPE (1 << TYPE_VEGTYPE)
+#define LAYER_VEGHEIGHT (1 << TYPE_VEGHEIGHT)
+#define LAYER_LAND (1 << TYPE_LAND)
+/// Every layer, including types this library doesn't know about
+#define LAYERS_ALL -1
+
+#define SOURCE_DIRECT 0
+#define SOURCE_CACHE 1
+#define SOURCE_MMAP 2
+
 #define LAND_NONE 0
 #define LAND_FOREST 1
 #define LAND_RESIDENTIAL 2
@@ -43,15 +58,35 @@ using namespace std;
 #define EC 0.082271854
 #define EC2 0.006768658
 
+/// Number of coordinates converted at a time by batch conversions
+#define CONVERT_CHUNK 64
+/// Most distinct conversions a SourceGroup will batch at once before falling back to converting each point
+#define CONVERT_GROUPS 4
+
+/// Take the value of the cell holding each sample, exactly like resolve()
+#define SAMPLE_NEAREST 0
+/// Interpolate between the centers of the four cells around each sample
+#define SAMPLE_BILINEAR 1
+
 
 /// Interface to convert a Point into another coordinate system that could be used to reference into a Source.
 class Convert {
 public:
+	virtual ~Convert() {}
+	
 	/// Convert the given Point into another coordinate system.
 	/// @param p Point to be converted
 	/// @param x Output x coordinate after conversion
 	/// @param y Output y coordinate after conversion
 	virtual void convert(Point* p, double* x, double* y);
+	
+	/// Convert many coordinates at once into another coordinate system.  Gives the same results as calling convert() on each of them.
+	/// @param lat Array of latitudes to convert
+	/// @param lon Array of longitudes to convert
+	/// @param count Number of coordinates to convert
+	/// @param x Output array with room for count x coordinates
+	/// @param y Output array with room for count y coordinates
+	virtual void convertList(const double* lat, const double* lon, int count, double* x, double* y);
 };
 
 
@@ -72,11 +107,21 @@ public:
 	/// @param y Output y coordinate after conversion
 	void convert(Point* p, double* x, double* y);
 	
+	/// Convert many coordinates at once into default Albers projection coordinate system.  Each stage runs over the whole array before the next one, so the compiler can vectorize the arithmetic between math library calls.
+	/// @param lat Array of latitudes to convert
+	/// @param lon Array of longitudes to convert
+	/// @param count Number of coordinates to convert
+	/// @param x Output array with room for count x coordinates
+	/// @param y Output array with room for count y coordinates
+	void convertList(const double* lat, const double* lon, int count, double* x, double* y);
+	
 };
 
 
 /// Interface to a data source.  Sources can be asked to fill Point objects with any available data.
 class Source {
+	friend class SourceGroup;
+	friend class BlockCache;
 protected:
 	/// Conversion to apply to each incoming Point
 	Convert* convert;
@@ -88,8 +133,94 @@ protected:
 	double cellsize;
 	/// Filename pointing at actual source datafile
 	string rawfilename;
-	/// Open stream to source datafile, if already opened
-	ifstream raw;
+	/// Open file descriptor to source datafile, or -1 if not opened yet.  Reads always go through pread() so that many threads can share it.
+	int raw;
+	/// Read-only memory map of the entire source datafile, or NULL if not mapped.  Pages are shared with every other process mapping the same file.
+	const char* mapped;
+	/// Length of the memory map, in bytes
+	long mappedSize;
+	/// Shared cache of blocks to read through when neither cached nor mapped, or NULL to read single cells directly
+	BlockCache* blocks;
+	
+	/// Open the source datafile named by rawfilename if it isn't already open.  Safe to call from multiple threads at once.
+	void openRaw();
+	
+	/// Read bytes from the source datafile at the given byte offset, without touching any shared file position.
+	/// @param buffer Output buffer to fill
+	/// @param length Number of bytes to read
+	/// @param offset Byte offset into the source datafile
+	/// @return True if all requested bytes were read
+	bool readRaw(char* buffer, long length, long offset);
+	
+	/// Memory map the source datafile named by rawfilename if it isn't already mapped.  Safe to call from multiple threads at once.
+	/// @param length Number of bytes to map, files shorter than this are left unmapped
+	void mapRaw(long length);
+	
+	/// Size of each cell in our data file, used to read blocks of cells through a BlockCache.
+	/// @return Cell size in bytes, or 0 if this source can't be read through a BlockCache
+	virtual int cellWidth();
+	
+	/// Read a single block of BLOCK_CELLS by BLOCK_CELLS cells from our data file, as raw bytes in rows BLOCK_CELLS cells wide.  Cells past the edge of our grid are left alone.
+	/// @param block Index of the block, counting across then down from the top left
+	/// @param buffer Output buffer with room for an entire block
+	/// @return True if every row was read
+	bool loadBlock(long block, char* buffer);
+	
+	/// Ask our BlockCache to read ahead the block holding the given coordinates.
+	/// @param x Point x coordinate after conversion
+	/// @param y Point y coordinate after conversion
+	void prefetchAt(double x, double y);
+	
+	/// Find the offset of the data cell holding the given coordinates, clamped onto our grid.
+	/// @param x Point x coordinate after conversion
+	/// @param y Point y coordinate after conversion
+	/// @return Offset of the cell, counting rows from the top
+	long cellOffset(double x, double y);
+	
+	/// Find the offsets of the data cells holding many coordinates at once, clamped onto our grid exactly like cellOffset().
+	/// @param xs Point x coordinates after conversion
+	/// @param ys Point y coordinates after conversion
+	/// @param count Number of coordinates
+	/// @param offsets Output array with room for count offsets
+	void cellOffsets(const double* xs, const double* ys, int count, long* offsets);
+	
+	/// Find the four cells whose centers surround each of many coordinates, and how far across them each coordinate lies.  Coordinates past the outer cell centers are clamped onto the edge cells.
+	/// @param xs Point x coordinates after conversion
+	/// @param ys Point y coordinates after conversion
+	/// @param count Number of coordinates
+	/// @param offsets Output array with room for 4 * count offsets, lower left, lower right, upper left and upper right for each coordinate
+	/// @param tx Output array with room for count fractions from the left cells towards the right ones
+	/// @param ty Output array with room for count fractions from the lower cells towards the upper ones
+	void cellCorners(const double* xs, const double* ys, int count, long* offsets, double* tx, double* ty);
+	
+	/// Read the raw values of many cells at once, exactly as value() would read each of them.
+	/// @param offsets Offsets of the cells to read
+	/// @param count Number of cells
+	/// @param values Output array with room for count values
+	/// @return True if the values were read, false if this source can only resolve whole points
+	virtual bool readCells(const long* offsets, int count, double* values);
+	
+	/// Find bounds on the raw values of every cell holding the given coordinates, without reading those cells.
+	/// @param xs Point x coordinates after conversion
+	/// @param ys Point y coordinates after conversion
+	/// @param count Number of coordinates
+	/// @param mode SAMPLE_NEAREST or SAMPLE_BILINEAR, so the bounds also cover the cells interpolated between
+	/// @param low Output value no larger than any value those points would resolve to
+	/// @param high Output value no smaller than any value those points would resolve to
+	/// @return True if bounds were found, false if this source can't bound its values
+	virtual bool bounds(const double* xs, const double* ys, int count, int mode, double* low, double* high);
+	
+	/// Read the raw value of the cell holding the given coordinates, exactly as resolveAt() would before handing it to fill().  Lets callers that only want one layer skip the Point entirely.
+	/// @param x Point x coordinate after conversion
+	/// @param y Point y coordinate after conversion
+	/// @param value Output raw value
+	/// @return True if the value was read, false if this source can only resolve whole points
+	virtual bool sample(double x, double y, double* value);
+	
+	/// Fill the given Point with a raw value read from our data file, interpreted according to our type.  Sources that only understand some types override this to ignore the rest.
+	/// @param p The point to fill with data
+	/// @param dv Raw value read from the data file
+	virtual void fill(Point* p, double dv);
 	
 	Source();
 	
@@ -99,14 +230,47 @@ protected:
 	Source(Convert* _convert, int _type);
 	
 public:
+	virtual ~Source();
+	
 	/// Resolve a given Point by filling it with any new data this source can provide.  Will ignore given point if this source can't provide data.
 	/// @param p The point to try filling with data
 	virtual void resolve(Point* p) = 0;
 	
+	/// Resolve a given Point that has already been converted into our coordinate system.  Lets callers share one conversion across many sources.
+	/// @param p The point to try filling with data
+	/// @param x Point x coordinate after conversion
+	/// @param y Point y coordinate after conversion
+	virtual void resolveAt(Point* p, double x, double y);
+	
+	/// Read the raw values under many coordinates at once, with one call instead of one resolve() per point.  Cell indexes are worked out for the whole batch first, and cells are then read together, so cached blocks are only looked up once for every run of samples they hold.  Land use, vegetation types and vegetation heights are all category codes, so they are always taken from the nearest cell.
+	/// @param xs Point x coordinates after conversion
+	/// @param ys Point y coordinates after conversion
+	/// @param count Number of coordinates
+	/// @param values Output array with room for count raw values, as fill() would receive them
+	/// @param mode SAMPLE_NEAREST for exactly the values resolveAt() would use, or SAMPLE_BILINEAR to interpolate between cell centers
+	/// @return True if the values were read, false if this source can only resolve whole points
+	virtual bool gather(const double* xs, const double* ys, int count, double* values, int mode);
+	
+	/// Find the extent of this source in its own coordinate system.
+	/// @param _left Output left edge
+	/// @param _bottom Output bottom edge
+	/// @param _right Output right edge
+	/// @param _top Output top edge
+	/// @return True if this source covers a known rectangle, false if it has no fixed extent
+	virtual bool extent(double* _left, double* _bottom, double* _right, double* _top);
+	
 	/// Resolve the entire list of Point objects by calling resolve() on each of them.
 	/// @param list List of Point objects to try resolving
 	void resolveList(vector<Point*> list);
 	
+	/// Resolve every sample of the given profile in place.  Allocates nothing, so it can be called for every path.
+	/// @param profile Profile whose samples should be filled with data
+	virtual void resolveProfile(TerrainProfile* profile);
+	
+	/// Read through the given shared BlockCache whenever this source isn't cached or mapped.  The cache must outlive this source.
+	/// @param cache Cache to share, or NULL to read single cells directly
+	virtual void setBlockCache(BlockCache* cache);
+	
 	/// Check if this source provides data about the given point.
 	/// @param p Point to check against
 	/// @return True if this source provides data about given point, otherwise false.
@@ -119,13 +283,25 @@ public:
 /// Interface to a data source.  Sources can be asked to fill Point objects with any available data.  Specifically handles data files in integer format, usually ending with ".bil" extension.
 class SourceInteger : public Source {
 protected:
-	/// Internal cache of entire data file, if requested
-	int* cache;
+	/// Internal cache of entire data file in its native 8-bit form, if requested
+	char* cache;
 	
 	/// Retrieve a specific value, either from raw source file, or from cache if it exists.
 	/// @param offset Offset into the data file to read
 	/// @return Value at offset location
-	int value(int offset);
+	int value(long offset);
+	
+	/// Each cell is a single byte.
+	int cellWidth();
+	
+	/// Read the cell holding the given coordinates, if we hold land use.
+	bool sample(double x, double y, double* value);
+	
+	/// Read many cells from our cache, map or block cache.  Only land use is read this way, like sample().
+	bool readCells(const long* offsets, int count, double* values);
+	
+	/// Integer files only ever held land use, so other types are ignored.
+	void fill(Point* p, double dv);
 	
 public:
 	
@@ -133,14 +309,20 @@ public:
 	/// @param convert The conversion to apply to all incoming points
 	/// @param type Enumeration value describing the type of data we provide
 	/// @param filename Filename pointing to ".hdr" file for this data source
-	/// @param cache Cache entire data file in memory if true, otherwise read directly from file when requested
-	SourceInteger(Convert* convert, int type, string filename, bool cache);
+	/// @param cache SOURCE_CACHE (or true) to load entire data file into memory, SOURCE_MMAP to map it into memory, otherwise SOURCE_DIRECT (or false) to read directly from file when requested
+	SourceInteger(Convert* convert, int type, string filename, int cache);
 	
 	~SourceInteger();
 	
 	/// Resolve a given Point by filling it with any new data this source can provide.  Will ignore given point if this source can't provide data.
 	/// @param p The point to try filling with data
 	void resolve(Point* p);
+	
+	/// Resolve a given Point that has already been converted into our coordinate system.
+	/// @param p The point to try filling with data
+	/// @param x Point x coordinate after conversion
+	/// @param y Point y coordinate after conversion
+	void resolveAt(Point* p, double x, double y);
 };
 
 
@@ -148,13 +330,43 @@ public:
 /// Interface to a data source.  Sources can be asked to fill Point objects with any available data.  Specifically handles data files in grid float format, usually ending with ".flt" extension.
 class SourceGridFloat : public Source {
 protected:
-	/// Internal cache of entire data file, if requested
-	double* cache;
+	/// True if the data file should be memory mapped when first opened
+	bool lazyMap;
+	
+	/// Internal cache of entire data file in its native 32-bit form, if requested
+	float* cache;
+	
+	/// Min/max pyramid over every cell, loaded or built when first needed, or NULL
+	ElevationPyramid* pyramid;
+	/// True once loading and building the pyramid have both failed, so we stop trying
+	bool pyramidFailed;
 	
 	/// Retrieve a specific value, either from raw source file, or from cache if it exists.
 	/// @param offset Offset into the data file to read
 	/// @return Value at offset location
-	double value(int offset);
+	double value(long offset);
+	
+	/// Each cell is a 32-bit float.
+	int cellWidth();
+	
+	/// Filename of the precomputed pyramid kept beside our data file, ending with ".pyr".
+	string pyramidFilename();
+	
+	/// Load our pyramid from beside the data file, or build it by reading every cell if that copy is missing or stale.  Safe to call from multiple threads at once.
+	/// @return Our pyramid, or NULL if the data file can't be read
+	ElevationPyramid* preparePyramid();
+	
+	/// Bound values using our pyramid, building it first if needed.
+	bool bounds(const double* xs, const double* ys, int count, int mode, double* low, double* high);
+	
+	/// Read the cell holding the given coordinates, opening the data file first if needed.
+	bool sample(double x, double y, double* value);
+	
+	/// Read many cells, opening the data file first if needed.
+	bool readCells(const long* offsets, int count, double* values);
+	
+	/// Float files hold elevation and vegetation, so land use is ignored.
+	void fill(Point* p, double dv);
 	
 public:
 	
@@ -162,8 +374,8 @@ public:
 	/// @param convert The conversion to apply to all incoming points
 	/// @param type Enumeration value describing the type of data we provide
 	/// @param filename Filename pointing to ".hdr" file for this data source
-	/// @param cache Cache entire data file in memory if true, otherwise read directly from file when requested
-	SourceGridFloat(Convert* convert, int type, string filename, bool cache);
+	/// @param cache SOURCE_CACHE (or true) to load entire data file into memory, SOURCE_MMAP to map it into memory, otherwise SOURCE_DIRECT (or false) to read directly from file when requested
+	SourceGridFloat(Convert* convert, int type, string filename, int cache);
 	
 	/// Create a new grid float data source.  This constructor is specifically used to bypass reading the ".hdr" header file, which can save time when using large numbers of data source tiles.
 	/// @param convert The conversion to apply to all incoming points
@@ -174,7 +386,8 @@ public:
 	/// @param _left Left longitude of the data file
 	/// @param _bottom Bottom latitude of the data file
 	/// @param _cellsize Size of each cell in the data file
-	SourceGridFloat(Convert* convert, int type, string filename, int _ncols, int _nrows, double _left, double _bottom, double _cellsize);
+	/// @param cache SOURCE_MMAP to map the data file into memory when first needed, otherwise SOURCE_DIRECT to read directly from file when requested
+	SourceGridFloat(Convert* convert, int type, string filename, int _ncols, int _nrows, double _left, double _bottom, double _cellsize, int cache = SOURCE_DIRECT);
 	
 	~SourceGridFloat();
 	
@@ -182,6 +395,16 @@ public:
 	/// @param p The point to try filling with data
 	void resolve(Point* p);
 	
+	/// Resolve a given Point that has already been converted into our coordinate system.
+	/// @param p The point to try filling with data
+	/// @param x Point x coordinate after conversion
+	/// @param y Point y coordinate after conversion
+	void resolveAt(Point* p, double x, double y);
+	
+	/// Build our min/max pyramid and write it beside the data file, so later runs can load it instead of reading every cell.
+	/// @return True if the pyramid was written
+	bool savePyramid();
+	
 };
 
 
@@ -191,13 +414,161 @@ class SourceGroup : public Source {
 private:
 	/// Internal list of all Source objects we know about
 	vector<Source*> list;
+	
+	/// Uniform grid of buckets covering every Source that shares a single Convert.  Each bucket lists the sources overlapping it, in the order they were added.
+	struct TileIndex {
+		Convert* convert;
+		double left, bottom, cellWidth, cellHeight;
+		int cols, rows;
+		/// Offset of each bucket into ids, with one extra entry marking the end
+		vector<int> start;
+		/// Indexes into list, grouped by bucket
+		vector<int> ids;
+	};
+	
+	/// Extent of each Source in list, in its own coordinate system
+	struct Extent {
+		double left, bottom, right, top;
+		/// False for sources without a fixed extent, which are always checked with contains()
+		bool bounded;
+	};
+	
+	/// Spatial index for each distinct Convert, built when first needed
+	vector<TileIndex*> indexes;
+	/// Extent of each Source in list
+	vector<Extent> extents;
+	/// Indexes into list of sources without a fixed extent, which are always checked
+	vector<int> unbounded;
+	/// Mask of LAYER_ELEV and friends for every type of data in list
+	int present;
+	/// True once indexes reflect everything in list
+	bool indexed;
+	/// Guards building indexes from multiple threads
+	pthread_mutex_t indexLock;
+	
+	/// Make sure the spatial index is up to date with list.  Safe to call from multiple threads at once.
+	void prepare();
+	
+	/// Throw away and rebuild the spatial index for everything in list.
+	void buildIndex();
+	
+	/// Clear out any existing spatial index.
+	void clearIndex();
+	
+	/// Find all sources that provide data about the given point, in the order they were added.
+	/// @param p Point to check against
+	/// @param found Output array of indexes into list
+	/// @param xs Output array of converted x coordinate for each source found
+	/// @param ys Output array of converted y coordinate for each source found
+	/// @param max Room available in the output arrays
+	/// @return Number of sources found, which may be larger than max
+	int lookup(Point* p, int* found, double* xs, double* ys, int max);
+	
+	/// Find all sources that provide data about the given point, using coordinates already converted for each spatial index.
+	/// @param p Point to check against
+	/// @param px Point x coordinate converted for each entry in indexes, or NULL to convert here
+	/// @param py Point y coordinate converted for each entry in indexes, or NULL to convert here
+	/// @param found Output array of indexes into list
+	/// @param xs Output array of converted x coordinate for each source found
+	/// @param ys Output array of converted y coordinate for each source found
+	/// @param max Room available in the output arrays
+	/// @return Number of sources found, which may be larger than max
+	int lookup(Point* p, double* px, double* py, int* found, double* xs, double* ys, int max);
+	
+	/// Resolve a given Point using coordinates already converted for each spatial index.
+	/// @param p The point to try filling with data
+	/// @param px Point x coordinate converted for each entry in indexes, or NULL to convert here
+	/// @param py Point y coordinate converted for each entry in indexes, or NULL to convert here
+	/// @param want Mask of LAYER_ELEV and friends, sources of any other type are skipped
+	void resolveConverted(Point* p, double* px, double* py, int want);
+	
+	/// Find the elevation at a given Point using coordinates already converted for each spatial index, without filling any other layer.
+	/// @param p Point to look up, only its latitude and longitude are used
+	/// @param px Point x coordinate converted for each entry in indexes
+	/// @param py Point y coordinate converted for each entry in indexes
+	/// @param elev Elevation to keep if no source covers the point
+	/// @return Elevation from the last elevation source covering the point
+	double elevationConverted(Point* p, double* px, double* py, double elev);
+	
+	/// Find the source that decides the elevation at a given Point, using coordinates already converted for each spatial index.
+	/// @param p Point to look up, only its latitude and longitude are used
+	/// @param px Point x coordinate converted for each entry in indexes
+	/// @param py Point y coordinate converted for each entry in indexes
+	/// @param x Output x coordinate converted for the source found
+	/// @param y Output y coordinate converted for the source found
+	/// @return Index into list of the last elevation source covering the point, -1 if none do, or -2 if the overlap is too deep to tell quickly
+	int elevationSource(Point* p, double* px, double* py, double* x, double* y);
+	
+	/// Cache shared with every source in list, or NULL
+	BlockCache* shared;
+	/// SAMPLE_NEAREST or SAMPLE_BILINEAR, used for elevation only
+	int sampling;
+	
 public:
+	SourceGroup();
+	
 	~SourceGroup();
 	
-	/// Add the given Source to this list of sources.  Will be used in any resolve() calls in the future.
+	/// Add the given Source to this list of sources.  Will be used in any resolve() calls in the future.  Shouldn't be called while other threads are resolving points.
 	/// @param s Source object to add to our list
 	void add(Source* s);
 	
+	/// Share the given BlockCache with every source in this group, including ones added later.
+	/// @param cache Cache to share, or NULL to read single cells directly
+	void setBlockCache(BlockCache* cache);
+	
+	/// Choose how elevation is read from now on.  Vegetation heights are category codes, so they are always taken from the nearest cell like the other layers.  Bilinear sampling gives smooth terrain between cell centers, so paths can be stepped more coarsely for the same accuracy, but results no longer match nearest sampling exactly and Coverage::cacheKey() keeps their results apart in a LossCache.  Each source is interpolated on its own, so samples near the edge of a tile are clamped onto that tile.  Shouldn't be called while other threads are resolving points.
+	/// @param mode SAMPLE_NEAREST, the default, or SAMPLE_BILINEAR
+	void setSampling(int mode);
+	
+	/// Find how elevation is currently read.
+	/// @return SAMPLE_NEAREST or SAMPLE_BILINEAR, as last passed to setSampling()
+	int samplingMode();
+	
+	/// Resolve every sample of the given profile in place.  Samples are converted in batches for each conversion in use, and when sharing a BlockCache, blocks along the whole profile are queued for read-ahead first.
+	/// @param profile Profile whose samples should be filled with data
+	void resolveProfile(TerrainProfile* profile);
+	
+	/// Resolve only some layers of every sample of the given profile in place, reading ahead like resolveProfile().
+	/// @param profile Profile whose samples should be filled with data
+	/// @param want Mask of LAYER_ELEV and friends to resolve, other layers are left untouched
+	void resolveProfile(TerrainProfile* profile, int want);
+	
+	/// Resolve a run of samples of the given profile in place, without reading ahead.  When elevation is the only layer wanted, samples are read straight into the profile without going through a Point, gathering every run of samples that falls in the same source with a single gather().
+	/// @param profile Profile whose samples should be filled with data
+	/// @param start Index of the first sample to resolve
+	/// @param count Number of samples to resolve
+	/// @param want Mask of LAYER_ELEV and friends to resolve, other layers are left untouched
+	void resolveProfile(TerrainProfile* profile, int start, int count, int want = LAYERS_ALL);
+	
+	/// Find bounds on the elevation of a run of samples of the given profile without resolving them.  Only works when every sample falls inside a single elevation source that can bound its values, and no other elevation source overlaps the run.
+	/// @param profile Profile whose samples have been discretized but not resolved
+	/// @param start Index of the first sample
+	/// @param count Number of samples, no more than CONVERT_CHUNK
+	/// @param want Mask of LAYER_ELEV and friends the caller will resolve, so other layers can be ignored
+	/// @param low Output elevation no larger than any sample would resolve to
+	/// @param high Output elevation no smaller than any sample would resolve to
+	/// @param layers Output set to true if wanted vegetation height or land use sources may also cover the run, in which case samples still need resolving for those
+	/// @return True if bounds were found, false if the samples must be resolved to learn their elevation
+	bool elevationBounds(TerrainProfile* profile, int start, int count, int want, double* low, double* high, bool* layers);
+	
+	/// Ask the shared BlockCache to read ahead data about the given point.
+	/// @param p Point that will be resolved soon
+	void prefetch(Point* p);
+	
+	/// Ask the shared BlockCache to read ahead data across the given area.
+	/// @param area Area that will be resolved soon
+	/// @param spacing Distance between points to read ahead, in kilometers, which should be smaller than a block
+	void prefetch(RegionArea* area, double spacing);
+	
+	/// Number of sources in this group.
+	/// @return Count of sources added so far
+	int size();
+	
+	/// Find which types of data this group can provide.
+	/// @return Mask of LAYER_ELEV and friends for every source added so far
+	int layers();
+	
 	/// Resolve a given Point by filling it with any new data this source can provide.  Will ignore given point if this source can't provide data.
 	/// @param p The point to try filling with data
 	void resolve(Point* p);
@@ -207,6 +578,10 @@ public:
 	/// @return True if any source provides data about given point, otherwise false.
 	bool contains(Point* p);
 	
+	/// Groups have no fixed extent of their own.
+	/// @return Always returns false.
+	bool extent(double* _left, double* _bottom, double* _right, double* _top);
+	
 };
 
 
@@ -0,0 +1,128 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include <time.h>
+
+using namespace std;
+
+// Instrumentation is compiled out completely unless built with -DLIBPROP_STATS,
+// for example "make -B DEBUG='-g -DLIBPROP_STATS'".  The reporting functions below
+// always exist, and simply report nothing when instrumentation is off.
+
+#define STAT_RESOLVES 0
+#define STAT_SEEKS 1
+#define STAT_BYTES_READ 2
+#define STAT_CACHE_HITS 3
+#define STAT_CACHE_MISSES 4
+#define STAT_PATHS 5
+#define STAT_DENIED_HORIZON 6
+#define STAT_DENIED_SIGHT 7
+#define STAT_DENIED_LONGLEY 8
+#define STAT_CULLED 9
+#define STAT_COUNTERS 10
+
+#define STAGE_VALUE 0
+#define STAGE_LOOKUP 1
+#define STAGE_CONVERT 2
+#define STAGE_DISCRETE 3
+#define STAGE_KNIFE 4
+#define STAGE_LONGLEY 5
+#define STAGE_COUNT 6
+
+#ifdef LIBPROP_STATS
+#define STATS_COUNT(counter, n) statsAdd((counter), (n))
+#define STATS_TIMER(stage) StatsTimer statsTimer##stage(stage)
+#else
+#define STATS_COUNT(counter, n)
+#define STATS_TIMER(stage)
+#endif
+
+
+/// Totals of every counter and stage timer across all threads, taken at a single moment.
+class StatsSnapshot {
+public:
+	/// True if this build was compiled with LIBPROP_STATS
+	bool enabled;
+	/// Wall clock time since the last statsReset(), in seconds
+	double seconds;
+	/// Value of each counter, indexed by STAT_RESOLVES and friends
+	long counters[STAT_COUNTERS];
+	/// Total time spent inside each stage, in nanoseconds, indexed by STAGE_VALUE and friends.  Stages nest, so time in a lookup also counts any conversion it does, and the knife and longley stages only cover the model itself.
+	long nanos[STAGE_COUNT];
+	/// Number of times each stage was entered
+	long calls[STAGE_COUNT];
+
+	StatsSnapshot();
+
+	/// Paths walked by either model for every second of wall clock time.
+	double pathsPerSecond();
+
+	/// Describe every counter and stage as a single JSON object.
+	/// @return JSON text
+	string json();
+
+	/// Write a human readable summary table.
+	/// @param output Stream to write the table into
+	void table(ostream& output);
+};
+
+
+/// Add to one of the counters for the calling thread.  Use STATS_COUNT() instead, so the call disappears when instrumentation is off.
+/// @param counter Counter to add to, such as STAT_RESOLVES
+/// @param n Amount to add
+void statsAdd(int counter, long n);
+
+/// Add elapsed time to one of the stages for the calling thread.  Usually called by StatsTimer.
+/// @param stage Stage to add to, such as STAGE_VALUE
+/// @param nanos Elapsed time, in nanoseconds
+void statsTime(int stage, long nanos);
+
+/// Total every thread's counters and timers.  Safe to call at any time, even while other threads are still counting.
+/// @return Totals at this moment
+StatsSnapshot statsSnapshot();
+
+/// Zero every counter and timer, and restart the wall clock used for throughput.
+void statsReset();
+
+
+/// Time the enclosing scope as part of the given stage.  Use STATS_TIMER() instead, so the timer disappears when instrumentation is off.
+class StatsTimer {
+private:
+	int stage;
+	struct timespec start;
+
+public:
+	/// Start timing the given stage.
+	/// @param _stage Stage to time, such as STAGE_VALUE
+	StatsTimer(int _stage) : stage(_stage) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+	}
+
+	~StatsTimer() {
+		struct timespec end;
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		statsTime(stage, (end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec));
+	}
+};
+
@@ -23,6 +23,7 @@
 #include "radio.h"
 #include "source.h"
 #include "utils.h"
+#include "coverage.h"
 
 #include <time.h>
 
@@ -38,5 +39,6 @@ void testAlbers();
 void testVegetation();
 void testInteger();
 void testTypePath();
+void testCoverage();
 
 
@@ -0,0 +1,175 @@
+/*
+	libprop -- library to simulate and measure radio signal propagation
+
+	Copyright (C) 2007 Jeffrey Sharkey, jsharkey.org
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <map>
+
+#include <pthread.h>
+
+using namespace std;
+
+#include "coverage.h"
+#include "geom.h"
+#include "losscache.h"
+#include "radio.h"
+#include "source.h"
+#include "utils.h"
+
+/// Width and height of every tile, in pixels
+#define TILE_SIZE 256
+/// Loss stored in raw tiles for pixels without any terrain data
+#define TILE_NODATA -1024
+
+#define TILE_RAW 0
+#define TILE_PNG 1
+
+
+/// Parameters of a single map tile request, parsed from a path such as "/tile/12/780/1460.png?tower=45.52,-111.24&tx=10&rx=2&eirp=4000&mhz=900&txant=0&rxant=0&sens=-100&color=255,0,0".
+class TileRequest {
+public:
+	/// Zoom level and tile coordinates in the usual XYZ web map scheme
+	int z, x, y;
+	/// Enumeration of output format, either TILE_RAW or TILE_PNG
+	int format;
+	double towerLat, towerLon;
+	/// Height of transmitter and receiver, in meters
+	double txHeight, rxHeight;
+	/// Transmitter power, in mW
+	double eirp;
+	/// Frequency that radios operate at, in MHz
+	double mhz;
+	/// Antenna gain of transmitter and receiver, in dB
+	double txAntenna, rxAntenna;
+	/// Weakest signal still drawn as covered, in dBm
+	double sens;
+	/// Color used to draw covered pixels
+	int r, g, b;
+
+	/// Create a request using a 10 meter tower, 2 meter receivers, 4 watt transmitter, no antennas, 900MHz radio system, -100dBm sensitivity, and red coverage.
+	TileRequest();
+
+	/// Fill this request from the given path, checking every value is in range.
+	/// @param path Path and query string from the request line
+	/// @return True if the path describes a valid tile request
+	bool parse(string path);
+
+	/// Describe every parameter that changes the attenuation across this tile, so requests differing only in power, antenna gain, sensitivity, color or format can share one calculation.
+	/// @param sources Sources the tile is calculated from, whose sampling mode and terrain layers change the attenuation too
+	/// @return Unique description of this tile
+	string key(SourceGroup* sources);
+
+	/// Find the latitude and longitude at the center of the given pixel.
+	/// @param px Pixel column, from the left edge
+	/// @param py Pixel row, from the top edge
+	/// @param lat Output latitude
+	/// @param lon Output longitude
+	void pixel(int px, int py, double* lat, double* lon);
+};
+
+
+/// Long-running server that keeps a SourceGroup resident and answers map tile requests over HTTP.  Each connection runs on its own thread, and requests for a tile that is already being calculated wait for that calculation instead of repeating it.
+class TileServer {
+private:
+	/// Single tile calculation that other requests may be waiting on
+	struct Pending {
+		pthread_cond_t done;
+		bool finished;
+		/// Number of requests still needing the result
+		int users;
+		double grid[TILE_SIZE * TILE_SIZE];
+	};
+
+	/// Pixels of a tile being checked for terrain data by maskTask()
+	struct TileMask {
+		TileRequest* request;
+		SourceGroup* sources;
+		/// Receiver at the center of every pixel, and whether any source covers it
+		Point* points;
+		bool* covered;
+	};
+
+	/// Identity handed to each connection thread
+	struct Connection {
+		TileServer* server;
+		int fd;
+	};
+
+	SourceGroup* sources;
+	/// Attenuation of earlier tiles, or NULL to calculate every tile again
+	LossCache* cache;
+	/// Workers that calculate the pixels of every tile, and whether we started them ourselves
+	ThreadPool* pool;
+	bool ownPool;
+	Coverage* coverage;
+
+	pthread_mutex_t lock;
+	/// Tiles currently being calculated, by key()
+	map<string, Pending*> inflight;
+	/// Most connections served at once, and how many are running
+	int limit, active;
+	pthread_cond_t slots;
+	/// Number of tiles calculated or found in the cache, and number of requests that shared another request's calculation
+	long computed, shared;
+
+	static void* main(void* data);
+
+	/// Answer the single request waiting on the given connection, then close it.
+	/// @param fd Connected socket
+	void serve(int fd);
+
+	/// Find the loss for every pixel of the requested tile, sharing any calculation already running for the same tile and reusing cached attenuation.
+	/// @param request Tile to calculate
+	/// @param grid Output array of TILE_SIZE * TILE_SIZE losses in dBm, rows from the top
+	void tile(TileRequest* request, double* grid);
+
+	/// Calculate the loss for every pixel of the requested tile with 1mW of power and no antenna gain, spreading the pixels with terrain across the pool and checking the cache first.
+	/// @param request Tile to calculate
+	/// @param grid Output array of TILE_SIZE * TILE_SIZE losses in dBm, rows from the top
+	void calculate(TileRequest* request, double* grid);
+
+	/// Pool task placing a receiver at every pixel of a TileMask and checking whether it has terrain data.
+	static void maskTask(void* arg, long start, long end, int worker);
+
+public:
+	/// Create a new tile server.
+	/// @param _sources SourceGroup to provide elevation and vegetation data for every tile
+	/// @param _limit Most connections to serve at once, or 0 to use two per online processor
+	/// @param _cache Cache of tile attenuation to check before calculating, or NULL for none
+	/// @param _pool Pool of workers to calculate tiles with, or NULL to start one per online processor
+	TileServer(SourceGroup* _sources, int _limit, LossCache* _cache = NULL, ThreadPool* _pool = NULL);
+
+	~TileServer();
+
+	/// Open a TCP socket listening on the loopback interface.
+	/// @param port Port to listen on
+	/// @return Listening socket, or -1 on failure
+	int listenTcp(int port);
+
+	/// Open a Unix domain socket listening at the given path, replacing any old socket there.
+	/// @param path Filesystem path of the socket
+	/// @return Listening socket, or -1 on failure
+	int listenUnix(string path);
+
+	/// Accept and answer connections forever.
+	/// @param listener Listening socket from listenTcp() or listenUnix()
+	void run(int listener);
+};
+
@@ -22,6 +22,8 @@
 #include <math.h>
 #include <float.h>
 #include <assert.h>
+#include <string.h>
+#include <stdint.h>
 
 #include <iostream>
 #include <time.h>
@@ -31,6 +33,20 @@ using namespace std;
 
 #define PI 3.14159
 #define RADIUS 6378.2064
+
+// hot loops marked with SIMD_CLONES are compiled for both avx2 and the baseline, and the best one is picked at
+// runtime.  Build with -DLIBPROP_NO_SIMD to keep only the baseline.  Unoptimized builds always do, since without
+// optimization the avx2 clones skip vzeroupper and slow down every sse instruction that runs after them.
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__OPTIMIZE__) && !defined(LIBPROP_NO_SIMD)
+#define SIMD_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+/// Four doubles handled together through GCC vector extensions, split into narrower instructions where avx2 isn't available
+typedef double v4df __attribute__((vector_size(32)));
+/// Lane mask from comparing two v4df values, with every bit set in lanes where the comparison holds
+typedef long long v4di __attribute__((vector_size(32)));
  
 /// Convert given degree value into radians
 double toRadians(double d);
@@ -43,6 +59,35 @@ double toDegrees(double r);
 /// @return Interpreted value expressed as a double
 double ieee_single(char *data2);
 
+/// Convert four bytes of little-endian IEEE single data into a native float.  Only swaps bytes on big-endian hosts, so on most machines this is a plain load.
+/// @param data Value to be converted, requires four bytes
+/// @return Value as a native float
+inline float ieee_native(const char* data) {
+	uint32_t bits;
+	memcpy(&bits, data, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	bits = __builtin_bswap32(bits);
+#endif
+	float value;
+	memcpy(&value, &bits, 4);
+	return value;
+}
+
+/// Convert an entire array of little-endian IEEE single data into native floats.  Written as a simple loop so the compiler can vectorize it.
+/// @param data Values to be converted, requires four bytes each
+/// @param values Output array of native floats
+/// @param count Number of values to convert
+void ieee_native_array(const char* data, float* values, long count);
+
+/// Widen a native float into a double, giving the same result as ieee_single() for infinity, NaN, and negative zero.
+/// @param value Native float value
+/// @return Value expressed as a double
+inline double ieee_widen(float value) {
+	if(value == 0) return 0;
+	if(!isfinite(value)) return (value < 0) ? -DBL_MAX : DBL_MAX;
+	return value;
+}
+
 
 
 /// Helpful class to express remaining time to a user.  Displays a progress bar with a remaining time in minutes and seconds.